@@ -0,0 +1,113 @@
+#ifndef BUTTON_ENGINE_H
+#define BUTTON_ENGINE_H
+
+#include "EventQueue.h"
+#include <stdint.h>
+
+// Knob button click detector.
+// Fed with debounced levels (from a timer armed by the GPIO interrupt) and
+// deadline expiries, it emits press / release / single / double / long-press
+// events into a queue drained by loop(). No Arduino dependency: the GPIO and
+// timer glue lives in the sketch, so the state machine can be driven on a
+// host.
+
+enum ButtonEventType { BTN_PRESS, BTN_RELEASE, BTN_SINGLE, BTN_DOUBLE, BTN_LONG };
+
+struct ButtonEvent {
+  ButtonEventType type;
+  uint32_t timestamp; // ms
+};
+
+struct ButtonConfig {
+  uint16_t debounceMs = 20;    // Line must be stable this long
+  uint16_t doubleClickMs = 300; // Max gap from release to second press
+  uint16_t longPressMs = 700;
+};
+
+class ButtonEngine {
+public:
+  explicit ButtonEngine(const ButtonConfig &c = ButtonConfig())
+      : cfg(c), isPressed(false), longFired(false), clickCount(0),
+        pressTime(0), releaseTime(0) {}
+
+  // Debounced line level. Repeated levels are ignored.
+  void onLevel(uint32_t now, bool pressed) {
+    if (pressed == isPressed)
+      return;
+    isPressed = pressed;
+
+    if (pressed) {
+      // A late timer may not have resolved the first click yet: a second
+      // press outside the gap is a new click, not the end of a double
+      if (clickCount == 1 && now - releaseTime > cfg.doubleClickMs) {
+        clickCount = 0;
+        emit(BTN_SINGLE, releaseTime + cfg.doubleClickMs);
+      }
+      pressTime = now;
+      longFired = false;
+      emit(BTN_PRESS, now);
+      return;
+    }
+
+    emit(BTN_RELEASE, now);
+    if (longFired) {
+      clickCount = 0;
+      return;
+    }
+    releaseTime = now;
+    if (++clickCount >= 2) {
+      emit(BTN_DOUBLE, now);
+      clickCount = 0;
+    }
+  }
+
+  // Resolve long-press and single-click deadlines that have passed.
+  void onTimer(uint32_t now) {
+    if (isPressed && !longFired && now - pressTime >= cfg.longPressMs) {
+      longFired = true;
+      clickCount = 0;
+      emit(BTN_LONG, now);
+    }
+    if (!isPressed && clickCount == 1 &&
+        now - releaseTime >= cfg.doubleClickMs) {
+      clickCount = 0;
+      emit(BTN_SINGLE, now);
+    }
+  }
+
+  // Next time onTimer() has work to do. False when idle.
+  bool nextDeadline(uint32_t &when) const {
+    if (isPressed && !longFired) {
+      when = pressTime + cfg.longPressMs;
+      return true;
+    }
+    if (!isPressed && clickCount == 1) {
+      when = releaseTime + cfg.doubleClickMs;
+      return true;
+    }
+    return false;
+  }
+
+  bool poll(ButtonEvent &ev) { return queue.pop(ev); }
+  uint32_t dropped() const { return queue.dropped(); }
+
+  ButtonConfig cfg;
+
+private:
+  EventQueue<ButtonEvent, 16> queue;
+
+  bool isPressed;
+  bool longFired;
+  uint8_t clickCount;
+  uint32_t pressTime;
+  uint32_t releaseTime;
+
+  void emit(ButtonEventType type, uint32_t now) {
+    ButtonEvent ev;
+    ev.type = type;
+    ev.timestamp = now;
+    queue.push(ev);
+  }
+};
+
+#endif
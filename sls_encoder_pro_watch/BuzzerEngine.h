@@ -0,0 +1,118 @@
+#ifndef BUZZER_ENGINE_H
+#define BUZZER_ENGINE_H
+
+#include "EventQueue.h"
+#include <stdint.h>
+
+// Non-blocking buzzer sequencer.
+// The UI queues patterns with play(); step() runs from a one-shot hardware
+// timer callback, picks up requests, handles priority/preemption and
+// returns the tone to output plus when to be called again. Nothing here
+// sleeps or touches hardware, so the sequencing can run on a host.
+
+struct BuzzerNote {
+  uint16_t freq; // Hz, 0 = rest
+  uint16_t ms;
+};
+
+enum BuzzerPriority { PRIO_PET = 1, PRIO_FEEDBACK = 2, PRIO_ALERT = 3 };
+
+struct BuzzerPattern {
+  const BuzzerNote *notes;
+  uint8_t count;
+  uint8_t priority; // Higher preempts lower, equal queues behind
+};
+
+struct BuzzerStep {
+  bool changed;    // Output frequency differs from the last step
+  uint16_t freq;   // Frequency to output now (0 = silent)
+  bool active;     // A pattern is still playing
+  uint32_t wakeMs; // Call step() again at this time when active
+};
+
+class BuzzerSequencer {
+public:
+  BuzzerSequencer()
+      : current(nullptr), index(0), noteEnd(0), lastFreq(0), pendHead(0),
+        pendCount(0) {}
+
+  // UI side. False if the request queue is full.
+  bool play(const BuzzerPattern &p) { return requests.push(&p); }
+
+  // Timer side.
+  BuzzerStep step(uint32_t now) {
+    const BuzzerPattern *req;
+    while (requests.pop(req)) {
+      if (!current || req->priority > current->priority)
+        start(req, now); // Preempt: the interrupted pattern is dropped
+      else
+        enqueue(req);
+    }
+
+    while (current && (int32_t)(now - noteEnd) >= 0) {
+      if (++index < current->count) {
+        noteEnd += current->notes[index].ms;
+      } else {
+        current = nullptr;
+        const BuzzerPattern *next = dequeue();
+        if (next)
+          start(next, now);
+      }
+    }
+
+    BuzzerStep st;
+    st.freq = current ? current->notes[index].freq : 0;
+    st.changed = st.freq != lastFreq;
+    st.active = current != nullptr;
+    st.wakeMs = noteEnd;
+    lastFreq = st.freq;
+    return st;
+  }
+
+  uint32_t dropped() const { return requests.dropped(); }
+
+private:
+  static const uint8_t PENDING = 4;
+
+  EventQueue<const BuzzerPattern *, 8> requests;
+  const BuzzerPattern *current;
+  uint8_t index;
+  uint32_t noteEnd;
+  uint16_t lastFreq;
+
+  // Patterns waiting behind an equal/higher priority one, highest first
+  const BuzzerPattern *pending[PENDING];
+  uint8_t pendHead;
+  uint8_t pendCount;
+
+  void start(const BuzzerPattern *p, uint32_t now) {
+    current = p;
+    index = 0;
+    noteEnd = now + p->notes[0].ms;
+  }
+
+  void enqueue(const BuzzerPattern *p) {
+    if (pendCount == PENDING)
+      return; // Busy and backed up: drop it, sounds are best effort
+    pending[(pendHead + pendCount++) % PENDING] = p;
+  }
+
+  const BuzzerPattern *dequeue() {
+    if (!pendCount)
+      return nullptr;
+    uint8_t best = 0;
+    for (uint8_t i = 1; i < pendCount; i++)
+      if (pending[(pendHead + i) % PENDING]->priority >
+          pending[(pendHead + best) % PENDING]->priority)
+        best = i;
+    const BuzzerPattern *p = pending[(pendHead + best) % PENDING];
+    // Close the gap keeping FIFO order among the rest
+    for (uint8_t i = best; i > 0; i--)
+      pending[(pendHead + i) % PENDING] = pending[(pendHead + i - 1) % PENDING];
+    pendHead = (pendHead + 1) % PENDING;
+    pendCount--;
+    return p;
+  }
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <atomic>
+#include <stdint.h>
+
+// Lock-free multi-producer / single-consumer event bus.
+// Bounded ring of fixed-size slots, each guarded by a sequence number
+// (Vyukov's bounded queue). post() never blocks or allocates, so it can be
+// called from ISRs, the network task and BLE callbacks on either core.
+// poll() must only be called from the UI task. N must be a power of two.
+template <typename T, uint32_t N> class EventBus {
+  static_assert((N & (N - 1)) == 0, "EventBus size must be a power of two");
+
+public:
+  EventBus() : enqueuePos(0), dequeuePos(0), drops(0), posted(0), maxDepth(0) {
+    for (uint32_t i = 0; i < N; i++)
+      slots[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  bool post(const T &ev) {
+    uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Slot *slot;
+    for (;;) {
+      slot = &slots[pos & (N - 1)];
+      uint32_t seq = slot->seq.load(std::memory_order_acquire);
+      int32_t diff = (int32_t)(seq - pos);
+      if (diff == 0) {
+        if (enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        drops.fetch_add(1, std::memory_order_relaxed); // Full
+        return false;
+      } else {
+        pos = enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+    slot->data = ev;
+    slot->seq.store(pos + 1, std::memory_order_release);
+
+    posted.fetch_add(1, std::memory_order_relaxed);
+    uint32_t depth = pos + 1 - dequeuePos.load(std::memory_order_relaxed);
+    uint32_t seen = maxDepth.load(std::memory_order_relaxed);
+    while (depth > seen &&
+           !maxDepth.compare_exchange_weak(seen, depth,
+                                           std::memory_order_relaxed)) {
+    }
+    return true;
+  }
+
+  bool poll(T &ev) {
+    uint32_t pos = dequeuePos.load(std::memory_order_relaxed);
+    Slot &slot = slots[pos & (N - 1)];
+    if ((int32_t)(slot.seq.load(std::memory_order_acquire) - (pos + 1)) < 0)
+      return false;
+    ev = slot.data;
+    slot.seq.store(pos + N, std::memory_order_release);
+    dequeuePos.store(pos + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  uint32_t depth() const {
+    return enqueuePos.load(std::memory_order_relaxed) -
+           dequeuePos.load(std::memory_order_relaxed);
+  }
+  uint32_t dropped() const { return drops.load(std::memory_order_relaxed); }
+  uint32_t total() const { return posted.load(std::memory_order_relaxed); }
+  uint32_t highWater() const { return maxDepth.load(std::memory_order_relaxed); }
+
+private:
+  struct Slot {
+    std::atomic<uint32_t> seq;
+    T data;
+  };
+
+  Slot slots[N];
+  std::atomic<uint32_t> enqueuePos;
+  std::atomic<uint32_t> dequeuePos;
+  std::atomic<uint32_t> drops;
+  std::atomic<uint32_t> posted;
+  std::atomic<uint32_t> maxDepth;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <atomic>
+#include <stdint.h>
+
+// Fixed-capacity single-producer / single-consumer ring buffer.
+// No allocation and no locks, so it is safe to push from an input callback
+// (or ISR) and pop from loop(). N must be a power of two.
+template <typename T, uint32_t N> class EventQueue {
+  static_assert((N & (N - 1)) == 0, "EventQueue size must be a power of two");
+
+public:
+  EventQueue() : head(0), tail(0), dropCount(0) {}
+
+  bool push(const T &ev) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= N) {
+      dropCount++; // Full: newest event is lost, never block the producer
+      return false;
+    }
+    slots[h & (N - 1)] = ev;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T &ev) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire))
+      return false;
+    ev = slots[t & (N - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const {
+    return head.load(std::memory_order_acquire) ==
+           tail.load(std::memory_order_acquire);
+  }
+
+  uint32_t size() const {
+    return head.load(std::memory_order_acquire) -
+           tail.load(std::memory_order_acquire);
+  }
+
+  uint32_t dropped() const { return dropCount; }
+
+private:
+  T slots[N];
+  std::atomic<uint32_t> head;
+  std::atomic<uint32_t> tail;
+  uint32_t dropCount;
+};
+
+#endif
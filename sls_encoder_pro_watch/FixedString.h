@@ -0,0 +1,34 @@
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <stddef.h>
+#include <string.h>
+
+// Fixed-capacity, always terminated string for results that outlive a
+// request (weather description, ...). Plain char storage and no
+// constructors: stays POD, so it can sit in snapshots and NVS blobs and
+// zero-initialised is empty. Longer input is cut off, never allocated.
+template <size_t N> struct FixedString {
+  char buf[N];
+
+  // False if s had to be truncated
+  bool set(const char *s) {
+    size_t n = s ? strnlen(s, N) : 0;
+    bool fits = n < N;
+    if (!fits)
+      n = N - 1;
+    memcpy(buf, s, n);
+    buf[n] = 0;
+    return fits;
+  }
+
+  void clear() { buf[0] = 0; }
+  const char *c_str() const { return buf; }
+  size_t length() const { return strnlen(buf, N); }
+  static size_t capacity() { return N - 1; }
+
+  bool operator==(const FixedString &o) const { return !strcmp(buf, o.buf); }
+  bool operator!=(const FixedString &o) const { return !(*this == o); }
+};
+
+#endif
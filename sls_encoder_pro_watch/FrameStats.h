@@ -0,0 +1,192 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Frame timing histograms.
+// A frame is one lv_timer_handler() pass that flushed at least one area.
+// Its time is split into flush (inside the display flush callback), render
+// (the rest of the pass) and idle (time blocked since the previous frame).
+// Each phase feeds a fixed-bucket histogram per screen, along with pixel
+// counts; report() prints approximate percentiles (bucket upper edge).
+// Pure C++ with caller-supplied timestamps, so a host simulator records
+// the same numbers. Build with -DFRAME_STATS=0 to turn every hook into a
+// no-op; at runtime setEnabled(false) reduces them to a single branch.
+
+#ifndef FRAME_STATS
+#define FRAME_STATS 1
+#endif
+
+enum FramePhase { PHASE_RENDER, PHASE_FLUSH, PHASE_IDLE, PHASE_COUNT };
+
+class FrameStats {
+public:
+  static const uint8_t MAX_SCREENS = 12;
+  static const uint8_t BUCKETS = 13;
+
+  FrameStats()
+      : enabled(true), inPass(false), passStart(0), flushStart(0), flushUs(0),
+        passPixels(0), idleUs(0), screenCount(0) {
+    memset(stats, 0, sizeof(stats));
+  }
+
+  void setEnabled(bool on) { enabled = on; }
+  bool isEnabled() const { return enabled; }
+
+  void nameScreen(const void *screen, const char *name) {
+    names[screenSlot(screen)] = name;
+  }
+
+  // Around lv_timer_handler()
+  void beginPass(uint32_t nowUs) {
+    if (!FRAME_STATS || !enabled)
+      return;
+    inPass = true;
+    passStart = nowUs;
+    flushUs = 0;
+    passPixels = 0;
+  }
+
+  void endPass(uint32_t nowUs, const void *screen) {
+    if (!FRAME_STATS || !enabled || !inPass)
+      return;
+    inPass = false;
+    if (!passPixels)
+      return; // Nothing was redrawn
+    uint32_t total = nowUs - passStart;
+    Stats &s = stats[screenSlot(screen)];
+    s.frames++;
+    s.pixels += passPixels;
+    if (passPixels > s.maxPixels)
+      s.maxPixels = passPixels;
+    add(s.hist[PHASE_RENDER], total > flushUs ? total - flushUs : 0);
+    add(s.hist[PHASE_FLUSH], flushUs);
+    add(s.hist[PHASE_IDLE], idleUs);
+    s.flushUs += flushUs;
+    idleUs = 0;
+  }
+
+  // Around the panel transfer in the flush callback
+  void beginFlush(uint32_t nowUs) {
+    if (!FRAME_STATS || !enabled)
+      return;
+    flushStart = nowUs;
+  }
+
+  void endFlush(uint32_t nowUs, uint32_t pixels) {
+    if (!FRAME_STATS || !enabled)
+      return;
+    flushUs += nowUs - flushStart;
+    passPixels += pixels;
+  }
+
+  void addIdle(uint32_t us) {
+    if (!FRAME_STATS || !enabled)
+      return;
+    idleUs += us;
+  }
+
+  // Print p50/p90/p99 (ms) per screen and phase, then clear.
+  template <typename Printer> void report(Printer &out) {
+    static const char *phaseNames[PHASE_COUNT] = {"render", "flush", "idle"};
+    char line[112];
+    out.println(enabled ? "Frames (ms, bucket upper bounds):"
+                        : "Frames: disabled");
+    for (uint8_t sc = 0; sc < screenCount; sc++) {
+      Stats &s = stats[sc];
+      if (!s.frames)
+        continue;
+      snprintf(line, sizeof(line),
+               "  %-10s frames=%lu px/frame avg=%lu max=%lu flush=%.1f Mpx/s",
+               names[sc] ? names[sc] : "?", (unsigned long)s.frames,
+               (unsigned long)(s.pixels / s.frames),
+               (unsigned long)s.maxPixels,
+               s.flushUs ? (float)s.pixels / s.flushUs : 0.0f);
+      out.println(line);
+      for (uint8_t ph = 0; ph < PHASE_COUNT; ph++) {
+        snprintf(line, sizeof(line),
+                 "    %-6s p50=%s%5.1f p90=%s%5.1f p99=%s%5.1f",
+                 phaseNames[ph], over(s.hist[ph], 50), pct(s.hist[ph], 50),
+                 over(s.hist[ph], 90), pct(s.hist[ph], 90),
+                 over(s.hist[ph], 99), pct(s.hist[ph], 99));
+        out.println(line);
+      }
+    }
+    memset(stats, 0, sizeof(stats));
+  }
+
+private:
+  struct Stats {
+    uint32_t hist[PHASE_COUNT][BUCKETS];
+    uint32_t frames;
+    uint64_t pixels;
+    uint64_t flushUs;
+    uint32_t maxPixels;
+  };
+
+  bool enabled;
+  bool inPass;
+  uint32_t passStart;
+  uint32_t flushStart;
+  uint32_t flushUs;
+  uint32_t passPixels;
+  uint32_t idleUs;
+
+  Stats stats[MAX_SCREENS];
+  const void *screens[MAX_SCREENS];
+  const char *names[MAX_SCREENS] = {};
+  uint8_t screenCount;
+
+  // Upper bucket edges in microseconds; the last bucket is open-ended
+  static uint32_t edge(uint8_t b) {
+    static const uint32_t EDGES[BUCKETS - 1] = {
+        500,   1000,  2000,  4000,  6000,  8000,
+        12000, 16000, 24000, 33000, 50000, 100000};
+    return EDGES[b < BUCKETS - 1 ? b : BUCKETS - 2];
+  }
+
+  static void add(uint32_t *hist, uint32_t us) {
+    uint8_t b = 0;
+    while (b < BUCKETS - 1 && us > edge(b))
+      b++;
+    hist[b]++;
+  }
+
+  static uint8_t bucketAt(const uint32_t *hist, int p) {
+    uint32_t total = 0;
+    for (uint8_t b = 0; b < BUCKETS; b++)
+      total += hist[b];
+    uint32_t target = (total * p + 99) / 100, seen = 0;
+    for (uint8_t b = 0; b < BUCKETS; b++) {
+      seen += hist[b];
+      if (seen >= target && seen)
+        return b;
+    }
+    return 0;
+  }
+
+  static float pct(const uint32_t *hist, int p) {
+    uint8_t b = bucketAt(hist, p);
+    return edge(b) / 1000.0f;
+  }
+
+  // Marks percentiles that fall in the open-ended bucket
+  static const char *over(const uint32_t *hist, int p) {
+    return bucketAt(hist, p) == BUCKETS - 1 ? ">" : " ";
+  }
+
+  uint8_t screenSlot(const void *screen) {
+    for (uint8_t i = 0; i < screenCount; i++)
+      if (screens[i] == screen)
+        return i;
+    if (screenCount < MAX_SCREENS) {
+      screens[screenCount] = screen;
+      return screenCount++;
+    }
+    return MAX_SCREENS - 1; // Overflow bucket
+  }
+};
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef GESTURE_ENGINE_H
+#define GESTURE_ENGINE_H
+
+#include "EventQueue.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+// Touch gesture recognizer.
+// Consumes timestamped touch samples (pressed + x/y) and emits recognised
+// gestures into a fixed queue. It has no Arduino/LVGL dependency and does no
+// I/O, so feed() is safe inside lv_indev_read() and the whole engine can be
+// driven on the host by replaying recorded touch traces.
+
+enum GestureType {
+  GESTURE_TAP,
+  GESTURE_DOUBLE_TAP,
+  GESTURE_LONG_PRESS,
+  GESTURE_SWIPE,
+  GESTURE_EDGE_SWIPE
+};
+
+enum GestureDir { DIR_NONE, DIR_LEFT, DIR_RIGHT, DIR_UP, DIR_DOWN };
+
+struct GestureEvent {
+  GestureType type;
+  GestureDir dir;     // Swipes only
+  int16_t x, y;       // Touch-down point
+  int16_t dx, dy;     // Total displacement at release
+  uint16_t duration;  // ms from touch-down
+  uint16_t velocity;  // px/s along the dominant axis (swipes only)
+  uint32_t timestamp; // ms, time the gesture was recognised
+};
+
+struct GestureConfig {
+  uint16_t tapMaxMs = 500;         // Release before this -> tap
+  uint16_t longPressMs = 800;      // Held still this long -> long press
+  uint16_t doubleTapMs = 300;      // Max gap between taps of a double tap
+  uint16_t slopPx = 20;            // Movement tolerated for tap/long press
+  uint16_t swipeMinPx = 60;        // Min travel along dominant axis
+  uint16_t swipeMinVelocity = 200; // px/s
+  uint16_t edgePx = 30;            // Start band for edge swipes
+  int16_t width = 390;
+  int16_t height = 390;
+};
+
+class GestureEngine {
+public:
+  explicit GestureEngine(const GestureConfig &c = GestureConfig())
+      : cfg(c), isDown(false), moved(false), longFired(false), downTime(0),
+        startX(0), startY(0), lastX(0), lastY(0), lastTapTime(0),
+        lastTapX(0), lastTapY(0), hasLastTap(false) {}
+
+  // Feed one touch sample. x/y are ignored when pressed is false.
+  void feed(uint32_t now, bool pressed, int16_t x, int16_t y) {
+    if (pressed) {
+      if (!isDown) {
+        isDown = true;
+        moved = false;
+        longFired = false;
+        downTime = now;
+        startX = lastX = x;
+        startY = lastY = y;
+        return;
+      }
+      lastX = x;
+      lastY = y;
+      if (!moved && (abs(x - startX) > cfg.slopPx ||
+                     abs(y - startY) > cfg.slopPx)) {
+        moved = true;
+      }
+      // Long press fires while still held so feedback is immediate
+      if (!moved && !longFired && now - downTime >= cfg.longPressMs) {
+        longFired = true;
+        emit(GESTURE_LONG_PRESS, DIR_NONE, now, 0);
+      }
+      return;
+    }
+
+    if (!isDown)
+      return;
+    isDown = false;
+
+    if (longFired)
+      return; // Release after a long press is not a separate gesture
+
+    uint32_t duration = now - downTime;
+    if (moved) {
+      recognizeSwipe(now, duration);
+      return;
+    }
+
+    if (duration <= cfg.tapMaxMs) {
+      emit(GESTURE_TAP, DIR_NONE, now, 0);
+      if (hasLastTap && now - lastTapTime <= cfg.doubleTapMs &&
+          abs(startX - lastTapX) <= cfg.slopPx &&
+          abs(startY - lastTapY) <= cfg.slopPx) {
+        emit(GESTURE_DOUBLE_TAP, DIR_NONE, now, 0);
+        hasLastTap = false; // A third tap starts a new sequence
+      } else {
+        hasLastTap = true;
+        lastTapTime = now;
+        lastTapX = startX;
+        lastTapY = startY;
+      }
+    }
+  }
+
+  bool poll(GestureEvent &ev) { return queue.pop(ev); }
+  uint32_t dropped() const { return queue.dropped(); }
+  bool isTouching() const { return isDown; }
+
+  GestureConfig cfg;
+
+private:
+  EventQueue<GestureEvent, 16> queue;
+
+  bool isDown;
+  bool moved;
+  bool longFired;
+  uint32_t downTime;
+  int16_t startX, startY;
+  int16_t lastX, lastY;
+
+  uint32_t lastTapTime;
+  int16_t lastTapX, lastTapY;
+  bool hasLastTap;
+
+  void recognizeSwipe(uint32_t now, uint32_t duration) {
+    int dx = lastX - startX;
+    int dy = lastY - startY;
+    bool horizontal = abs(dx) >= abs(dy);
+    int travel = horizontal ? abs(dx) : abs(dy);
+    if (travel < cfg.swipeMinPx)
+      return;
+
+    uint32_t velocity = (uint32_t)travel * 1000 / (duration ? duration : 1);
+    if (velocity < cfg.swipeMinVelocity)
+      return;
+
+    GestureDir dir;
+    bool fromEdge;
+    if (horizontal) {
+      dir = dx > 0 ? DIR_RIGHT : DIR_LEFT;
+      fromEdge = dx > 0 ? startX <= cfg.edgePx
+                        : startX >= cfg.width - cfg.edgePx;
+    } else {
+      dir = dy > 0 ? DIR_DOWN : DIR_UP;
+      fromEdge = dy > 0 ? startY <= cfg.edgePx
+                        : startY >= cfg.height - cfg.edgePx;
+    }
+    emit(fromEdge ? GESTURE_EDGE_SWIPE : GESTURE_SWIPE, dir, now,
+         velocity > 0xFFFF ? 0xFFFF : velocity);
+  }
+
+  void emit(GestureType type, GestureDir dir, uint32_t now,
+            uint32_t velocity) {
+    GestureEvent ev;
+    ev.type = type;
+    ev.dir = dir;
+    ev.x = startX;
+    ev.y = startY;
+    ev.dx = lastX - startX;
+    ev.dy = lastY - startY;
+    uint32_t duration = now - downTime;
+    ev.duration = duration > 0xFFFF ? 0xFFFF : duration;
+    ev.velocity = velocity;
+    ev.timestamp = now;
+    queue.push(ev);
+  }
+};
+
+#endif
@@ -0,0 +1,225 @@
+#ifndef GZIP_READER_H
+#define GZIP_READER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include <sdkconfig.h>
+#if CONFIG_IDF_TARGET_ESP32S3
+#include "esp32s3/rom/miniz.h" // tinfl in ROM
+#else
+#include "rom/miniz.h"
+#endif
+#else
+#include "miniz.h" // Host builds: test/miniz.h, a stand-in for tinfl
+#endif
+
+// Streaming gzip decoder for an HTTP body (Content-Encoding: gzip).
+// Pulls compressed bytes from the source only as the inflater needs them
+// and serves the output through read() / readBytes(), the reader interface
+// deserializeJson() takes, so a filtered parse runs straight off the
+// socket. tinfl inflates into a 32 KB ring that doubles as the deflate
+// history window; it and the decompressor state are supplied by the caller
+// (allocated once, PSRAM is fine). The gzip trailer is never read.
+// An identity body passes straight through, so a fetch has one reader type
+// whatever the server sent.
+// Source needs available(), read(uint8_t *, size_t) (non-blocking) and
+// readBytes(char *, size_t) (blocking with a timeout), like WiFiClient.
+
+template <typename Source> class GzipReader {
+public:
+  static const size_t WINDOW = TINFL_LZ_DICT_SIZE;
+
+  // length: bytes of body left to read (Content-Length), -1 if unknown
+  GzipReader(Source &src, uint8_t *window, tinfl_decompressor *state,
+             int32_t length = -1)
+      : src(src), dict(window), inf(state), remaining(length), inPos(0),
+        inLen(0), outPos(0), outEnd(0), done(false), error(false),
+        gzip(false), inTotal(0), outTotal(0) {}
+
+  // compressed: the response said Content-Encoding: gzip. Parses the gzip
+  // header, false if the body isn't gzip after all.
+  bool begin(bool compressed) {
+    gzip = compressed;
+    if (!gzip)
+      return true;
+    uint8_t h[10];
+    for (uint8_t i = 0; i < sizeof(h); i++) {
+      int c = nextIn();
+      if (c < 0)
+        return fail();
+      h[i] = c;
+    }
+    if (h[0] != 0x1f || h[1] != 0x8b || h[2] != 8) // Magic, deflate
+      return fail();
+    uint8_t flags = h[3];
+    if (flags & 4) { // FEXTRA
+      int lo = nextIn(), hi = nextIn();
+      if (hi < 0 || !skip(lo | hi << 8))
+        return fail();
+    }
+    if ((flags & 8) && !skipString()) // FNAME
+      return fail();
+    if ((flags & 16) && !skipString()) // FCOMMENT
+      return fail();
+    if ((flags & 2) && !skip(2)) // FHCRC
+      return fail();
+    tinfl_init(inf);
+    return true;
+  }
+
+  int read() {
+    char c;
+    return readBytes(&c, 1) ? (uint8_t)c : -1;
+  }
+
+  size_t readBytes(char *buf, size_t n) {
+    if (!gzip) {
+      if (remaining >= 0 && n > (size_t)remaining)
+        n = remaining;
+      size_t k = n ? src.readBytes(buf, n) : 0;
+      inTotal += k;
+      outTotal += k;
+      if (remaining > 0)
+        remaining -= k;
+      return k;
+    }
+    size_t got = 0;
+    while (got < n) {
+      if (outPos == outEnd && !inflateMore())
+        break;
+      size_t k = outEnd - outPos;
+      if (k > n - got)
+        k = n - got;
+      memcpy(buf + got, dict + outPos, k);
+      outPos += k;
+      got += k;
+    }
+    return got;
+  }
+
+  // Reads what the parser left of the body (the gzip trailer, say), so the
+  // connection can carry another request. False if that can't be done.
+  bool drain() {
+    if (remaining < 0)
+      return false; // No Content-Length: the body ends when the server closes
+    char scratch[64];
+    while (remaining > 0) {
+      size_t want = (size_t)remaining < sizeof(scratch) ? remaining
+                                                         : sizeof(scratch);
+      size_t k = src.readBytes(scratch, want);
+      if (!k)
+        return false;
+      inTotal += k;
+      remaining -= k;
+    }
+    return true;
+  }
+
+  bool failed() const { return error; }
+  bool compressed() const { return gzip; }
+  bool finished() const { return done && outPos == outEnd; }
+  uint32_t wireBytes() const { return inTotal; } // Read from source
+  uint32_t bodyBytes() const { return outTotal; } // Served to the parser
+
+private:
+  static const size_t IN_BUF = 256;
+
+  Source &src;
+  uint8_t *dict;
+  tinfl_decompressor *inf;
+  int32_t remaining;
+  uint8_t in[IN_BUF];
+  size_t inPos, inLen;
+  size_t outPos, outEnd; // Unread output, inside dict
+  bool done;
+  bool error;
+  bool gzip;
+  uint32_t inTotal;
+  uint32_t outTotal;
+
+  bool fail() {
+    error = true;
+    return false;
+  }
+
+  // Next compressed chunk: what has arrived, or block for one byte
+  bool refill() {
+    inPos = inLen = 0;
+    if (remaining == 0)
+      return false;
+    size_t want = IN_BUF;
+    if (remaining > 0 && (size_t)remaining < want)
+      want = remaining;
+    int avail = src.available();
+    int n;
+    if (avail > 0)
+      n = src.read(in, (size_t)avail < want ? (size_t)avail : want);
+    else
+      n = (int)src.readBytes((char *)in, 1);
+    if (n <= 0) {
+      remaining = 0; // Closed or timed out
+      return false;
+    }
+    inLen = n;
+    inTotal += n;
+    if (remaining > 0)
+      remaining -= n;
+    return true;
+  }
+
+  int nextIn() {
+    if (inPos == inLen && !refill())
+      return -1;
+    return in[inPos++];
+  }
+
+  bool skip(uint32_t n) {
+    while (n--)
+      if (nextIn() < 0)
+        return false;
+    return true;
+  }
+
+  bool skipString() {
+    int c;
+    while ((c = nextIn()) > 0) {
+    }
+    return c == 0;
+  }
+
+  // Inflates the next piece into the ring after what was served last
+  bool inflateMore() {
+    if (done || error)
+      return false;
+    size_t ofs = outEnd & (WINDOW - 1);
+    for (;;) {
+      if (inPos == inLen)
+        refill(); // Nothing left: tinfl finishes or reports truncation
+      size_t inBytes = inLen - inPos;
+      size_t outBytes = WINDOW - ofs;
+      uint32_t flags = remaining != 0 ? TINFL_FLAG_HAS_MORE_INPUT : 0;
+      tinfl_status st = tinfl_decompress(inf, in + inPos, &inBytes, dict,
+                                         dict + ofs, &outBytes, flags);
+      inPos += inBytes;
+      if (st < TINFL_STATUS_DONE)
+        return fail();
+      done = st == TINFL_STATUS_DONE;
+      if (outBytes) {
+        outPos = ofs;
+        outEnd = ofs + outBytes;
+        outTotal += outBytes;
+        return true;
+      }
+      if (done)
+        return false;
+      if (st == TINFL_STATUS_NEEDS_MORE_INPUT && remaining == 0 &&
+          inPos == inLen)
+        return fail(); // Body ended mid-stream
+    }
+  }
+};
+
+#endif
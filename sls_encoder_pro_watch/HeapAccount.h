@@ -0,0 +1,228 @@
+#ifndef HEAP_ACCOUNT_H
+#define HEAP_ACCOUNT_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Heap accounting per subsystem.
+// Allocations made through alloc() carry an 8-byte header with their size,
+// tag and memory kind, so free() can credit the right counters. Live bytes,
+// peak bytes and allocation counts are kept per (tag, internal/PSRAM).
+// Subsystems that allocate inside libraries we can't hook (NimBLE,
+// HTTPClient) are measured around their setup and booked with note().
+// The backend (heap_caps_* on device, malloc on a host) is supplied by the
+// caller; report() also takes the allocator's free / largest-block figures
+// and prints fragmentation as 1 - largest free block / total free.
+
+enum HeapTag {
+  HEAP_LVGL,
+  HEAP_ENGINES,
+  HEAP_DISPLAY,
+  HEAP_NET,
+  HEAP_BLE,
+  HEAP_DEBUG,
+  HEAP_TAG_COUNT
+};
+
+enum HeapKind { HEAP_INTERNAL, HEAP_PSRAM, HEAP_KIND_COUNT };
+
+struct HeapBackend {
+  void *(*alloc)(size_t size, uint32_t caps); // caps 0 = default
+  void *(*realloc)(void *p, size_t size);      // Like realloc()
+  void (*free)(void *p);
+  bool (*isPsram)(const void *p);
+};
+
+// Allocator state of one memory kind, filled in by the caller
+struct HeapRegion {
+  uint32_t total;
+  uint32_t free;
+  uint32_t largest; // Largest free block
+  uint32_t minFree; // Low-water mark since boot
+};
+
+class HeapAccount {
+public:
+  explicit HeapAccount(const HeapBackend &backend)
+      : backend(backend), badFrees(0) {}
+
+  void *alloc(HeapTag tag, size_t size, uint32_t caps = 0) {
+    Header *h = (Header *)backend.alloc(size + sizeof(Header), caps);
+    if (!h) {
+      failures.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    h->size = size;
+    h->tag = tag;
+    h->kind = backend.isPsram(h) ? HEAP_PSRAM : HEAP_INTERNAL;
+    h->magic = MAGIC;
+    Counters &c = counters[tag][h->kind];
+    c.allocs.fetch_add(1, std::memory_order_relaxed);
+    add(c, (int32_t)size);
+    return h + 1;
+  }
+
+  void free(void *p) {
+    if (!p)
+      return;
+    Header *h = (Header *)p - 1;
+    if (h->magic != MAGIC || h->tag >= HEAP_TAG_COUNT) {
+      badFrees++; // Not ours: leak it rather than corrupt the heap
+      return;
+    }
+    h->magic = 0;
+    Counters &c = counters[h->tag][h->kind];
+    c.frees.fetch_add(1, std::memory_order_relaxed);
+    add(c, -(int32_t)h->size);
+    backend.free(h);
+  }
+
+  // Keeps the block's tag (newTag for p == NULL). The backend resizes in
+  // place when it can; the counters move by the size difference, or to the
+  // other memory kind if the block moved there.
+  void *realloc(void *p, size_t size, HeapTag newTag) {
+    if (!p)
+      return alloc(newTag, size);
+    Header *h = (Header *)p - 1;
+    if (h->magic != MAGIC)
+      return nullptr;
+    uint32_t oldSize = h->size;
+    uint8_t oldKind = h->kind;
+    h = (Header *)backend.realloc(h, size + sizeof(Header));
+    if (!h) {
+      failures.fetch_add(1, std::memory_order_relaxed);
+      return nullptr; // The old block is untouched
+    }
+    h->size = size;
+    h->kind = backend.isPsram(h) ? HEAP_PSRAM : HEAP_INTERNAL;
+    Counters &from = counters[h->tag][oldKind];
+    Counters &to = counters[h->tag][h->kind];
+    if (&from == &to) {
+      add(to, (int32_t)size - (int32_t)oldSize);
+    } else {
+      from.frees.fetch_add(1, std::memory_order_relaxed);
+      add(from, -(int32_t)oldSize);
+      to.allocs.fetch_add(1, std::memory_order_relaxed);
+      add(to, (int32_t)size);
+    }
+    return h + 1;
+  }
+
+  // Book memory allocated elsewhere (measured by the caller).
+  void note(HeapTag tag, HeapKind kind, int32_t bytes) {
+    add(counters[tag][kind], bytes);
+  }
+
+  uint32_t live(HeapTag tag, HeapKind kind) const {
+    return counters[tag][kind].live.load(std::memory_order_relaxed);
+  }
+  uint32_t peak(HeapTag tag, HeapKind kind) const {
+    return counters[tag][kind].peak.load(std::memory_order_relaxed);
+  }
+
+  // Live bytes over all tags
+  uint32_t tagged(HeapKind kind) const {
+    uint32_t sum = 0;
+    for (uint8_t t = 0; t < HEAP_TAG_COUNT; t++)
+      sum += live((HeapTag)t, kind);
+    return sum;
+  }
+
+  template <typename Printer>
+  void report(Printer &out, const HeapRegion regions[HEAP_KIND_COUNT]) {
+    static const char *tagNames[HEAP_TAG_COUNT] = {
+        "lvgl", "engines", "display", "net", "ble", "debug"};
+    static const char *kindNames[HEAP_KIND_COUNT] = {"internal", "psram"};
+    char line[112];
+    out.println("Heap by subsystem (bytes):");
+    for (uint8_t k = 0; k < HEAP_KIND_COUNT; k++) {
+      uint32_t tagged = 0;
+      for (uint8_t t = 0; t < HEAP_TAG_COUNT; t++) {
+        const Counters &c = counters[t][k];
+        uint32_t allocs = c.allocs.load(std::memory_order_relaxed);
+        uint32_t liveB = c.live.load(std::memory_order_relaxed);
+        if (!allocs && !liveB && !c.peak.load(std::memory_order_relaxed))
+          continue;
+        tagged += liveB;
+        snprintf(line, sizeof(line),
+                 "  %-8s %-7s live=%8lu peak=%8lu allocs=%7lu frees=%7lu",
+                 kindNames[k], tagNames[t], (unsigned long)liveB,
+                 (unsigned long)c.peak.load(std::memory_order_relaxed),
+                 (unsigned long)allocs,
+                 (unsigned long)c.frees.load(std::memory_order_relaxed));
+        out.println(line);
+      }
+      const HeapRegion &r = regions[k];
+      if (!r.total)
+        continue;
+      uint32_t used = r.total - r.free;
+      snprintf(line, sizeof(line),
+               "  %-8s used=%lu/%lu untagged=%lu min_free=%lu largest=%lu "
+               "frag=%.0f%%",
+               kindNames[k], (unsigned long)used, (unsigned long)r.total,
+               (unsigned long)(used > tagged ? used - tagged : 0),
+               (unsigned long)r.minFree, (unsigned long)r.largest,
+               fragmentation(r) * 100.0f);
+      out.println(line);
+    }
+    snprintf(line, sizeof(line), "  failed allocs=%lu foreign frees=%lu",
+             (unsigned long)failures.load(std::memory_order_relaxed),
+             (unsigned long)badFrees);
+    out.println(line);
+  }
+
+  static float fragmentation(const HeapRegion &r) {
+    return r.free ? 1.0f - (float)r.largest / r.free : 0.0f;
+  }
+
+private:
+  static const uint16_t MAGIC = 0xA110;
+
+  // 8 bytes keeps the backend's alignment
+  struct Header {
+    uint32_t size;
+    uint8_t tag;
+    uint8_t kind;
+    uint16_t magic;
+  };
+
+  struct Counters {
+    std::atomic<uint32_t> live{0};
+    std::atomic<uint32_t> peak{0};
+    std::atomic<uint32_t> allocs{0};
+    std::atomic<uint32_t> frees{0};
+  };
+
+  HeapBackend backend;
+  Counters counters[HEAP_TAG_COUNT][HEAP_KIND_COUNT];
+  std::atomic<uint32_t> failures{0};
+  uint32_t badFrees;
+
+  static void add(Counters &c, int32_t delta) {
+    uint32_t now =
+        c.live.fetch_add((uint32_t)delta, std::memory_order_relaxed) + delta;
+    uint32_t seen = c.peak.load(std::memory_order_relaxed);
+    while ((int32_t)now > 0 && now > seen &&
+           !c.peak.compare_exchange_weak(seen, now,
+                                         std::memory_order_relaxed)) {
+    }
+  }
+};
+
+// Temporarily books allocations that use *slot to another tag, e.g. LVGL
+// objects created by an engine (single task only).
+class HeapTagScope {
+public:
+  HeapTagScope(HeapTag *slot, HeapTag tag) : slot(slot), saved(*slot) {
+    *slot = tag;
+  }
+  ~HeapTagScope() { *slot = saved; }
+
+private:
+  HeapTag *slot;
+  HeapTag saved;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef HID_ACTION_QUEUE_H
+#define HID_ACTION_QUEUE_H
+
+#include <stdint.h>
+
+// Timed queue of HID mouse reports.
+// Multi-step gestures (cursor kick, scroll shake, return to origin) are
+// queued with gaps between steps instead of delay(); advance() sends the
+// reports that are due. Templated on the mouse type so a mock with a
+// move(x, y, wheel) method can stand in for BleMouse on a host.
+template <typename Mouse, uint8_t N = 16> class HidActionQueue {
+public:
+  HidActionQueue() : head(0), count(0), lastAt(0), merges(0), drops(0) {}
+
+  // Queue a report delayMs after the previous queued one (or after now if
+  // the queue is idle). When full, an immediate scroll is added to the last
+  // queued scroll-only report, up to what one report can carry; anything
+  // else is dropped and counted. False if any of it was dropped.
+  bool then(uint32_t now, uint16_t delayMs, int8_t x, int8_t y,
+            int8_t wheel = 0) {
+    if (count == N) {
+      Action &last = actions[(head + count - 1) % N];
+      if (!delayMs && !x && !y && wheel && !last.x && !last.y && last.wheel) {
+        int16_t sum = last.wheel + wheel;
+        last.wheel = sum > 127 ? 127 : (sum < -127 ? -127 : sum);
+        merges++;
+        if (last.wheel == sum)
+          return true;
+      }
+      drops++;
+      return false;
+    }
+    uint32_t base = (count && (int32_t)(lastAt - now) > 0) ? lastAt : now;
+    Action &a = actions[(head + count++) % N];
+    a.at = base + delayMs;
+    a.x = x;
+    a.y = y;
+    a.wheel = wheel;
+    lastAt = a.at;
+    return true;
+  }
+
+  // Send every report whose time has come, in order.
+  void advance(uint32_t now, Mouse &mouse) {
+    while (count && (int32_t)(now - actions[head].at) >= 0) {
+      Action &a = actions[head];
+      mouse.move(a.x, a.y, a.wheel);
+      head = (head + 1) % N;
+      count--;
+    }
+  }
+
+  void clear() { count = 0; }
+  bool idle() const { return count == 0; }
+  uint32_t merged() const { return merges; }   // Scrolls folded in when full
+  uint32_t dropped() const { return drops; }   // Reports (or parts) lost
+
+private:
+  struct Action {
+    uint32_t at;
+    int8_t x, y, wheel;
+  };
+
+  Action actions[N];
+  uint8_t head;
+  uint8_t count;
+  uint32_t lastAt;
+  uint32_t merges;
+  uint32_t drops;
+};
+
+#endif
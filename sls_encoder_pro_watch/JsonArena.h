@@ -0,0 +1,98 @@
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <ArduinoJson.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ArduinoJson allocator over a static pool, so parsing a response never
+// touches the heap. Bump allocation: only the newest block can grow in
+// place or be given back; freeing an older block leaves a hole until every
+// block is freed, which resets the arena. That matches a document's life:
+// pools and strings grow at the end while parsing, shrinkToFit() trims
+// them, and destroying the document empties the arena for the next
+// request. One document at a time, one task only.
+// Out of space returns NULL, which ArduinoJson reports as NoMemory.
+
+template <size_t N> class JsonArena : public ArduinoJson::Allocator {
+public:
+  JsonArena() : top(0), blocks(0), peakBytes(0), overflowCount(0) {}
+
+  void *allocate(size_t size) override {
+    size_t need = HEADER + align(size);
+    if (need > N - top) {
+      overflowCount++;
+      return nullptr;
+    }
+    uint8_t *b = pool + top;
+    *(uint32_t *)b = (uint32_t)size;
+    top += need;
+    blocks++;
+    if (top > peakBytes)
+      peakBytes = top;
+    return b + HEADER;
+  }
+
+  void deallocate(void *p) override {
+    if (!p)
+      return;
+    if (isNewest(p))
+      top = (uint8_t *)p - HEADER - pool;
+    if (--blocks == 0)
+      top = 0;
+  }
+
+  void *reallocate(void *p, size_t size) override {
+    if (!p)
+      return allocate(size);
+    uint8_t *b = (uint8_t *)p - HEADER;
+    uint32_t old = *(uint32_t *)b;
+    if (isNewest(p)) {
+      size_t start = (uint8_t *)p - pool;
+      if (align(size) > N - start) {
+        overflowCount++;
+        return nullptr;
+      }
+      *(uint32_t *)b = (uint32_t)size;
+      top = start + align(size);
+      if (top > peakBytes)
+        peakBytes = top;
+      return p;
+    }
+    if (size <= old) {
+      *(uint32_t *)b = (uint32_t)size; // Shrink in place, tail is a hole
+      return p;
+    }
+    void *q = allocate(size);
+    if (!q)
+      return nullptr;
+    memcpy(q, p, old);
+    deallocate(p);
+    return q;
+  }
+
+  size_t used() const { return top; }
+  size_t peak() const { return peakBytes; }
+  uint32_t overflows() const { return overflowCount; }
+  static size_t capacity() { return N; }
+
+private:
+  static const size_t ALIGN = 8;      // Doubles, pointers on 64-bit hosts
+  static const size_t HEADER = ALIGN; // Block size, padded
+
+  static size_t align(size_t n) { return (n + ALIGN - 1) & ~(ALIGN - 1); }
+
+  bool isNewest(void *p) const {
+    uint32_t size = *(uint32_t *)((uint8_t *)p - HEADER);
+    return (uint8_t *)p + align(size) == pool + top;
+  }
+
+  alignas(8) uint8_t pool[N];
+  size_t top;
+  uint32_t blocks;
+  size_t peakBytes;
+  uint32_t overflowCount;
+};
+
+#endif
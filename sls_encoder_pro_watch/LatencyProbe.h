@@ -0,0 +1,146 @@
+#ifndef LATENCY_PROBE_H
+#define LATENCY_PROBE_H
+
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Input-to-photon latency harness.
+// 1. The ISR/driver stamps the raw input time (micros()).
+// 2. The handler that reacts to it calls arm() with that stamp, the affected
+//    widget area and the active screen.
+// 3. onFlush() closes every armed probe on the flushed screen whose area
+//    intersects the flushed area and records (flush time - input time).
+// Samples are kept per input kind and per screen; report() prints
+// p50/p95/p99. Pure C++ so the same code runs in a host simulator.
+
+enum InputKind { INPUT_ENCODER, INPUT_TOUCH, INPUT_BUTTON, INPUT_KIND_COUNT };
+
+class LatencyProbe {
+public:
+  static const uint8_t MAX_SCREENS = 12;
+  static const uint16_t SAMPLES = 128;      // Ring per (kind, screen)
+  static const uint32_t TIMEOUT_US = 1000000; // Input that never redraws
+
+  LatencyProbe() : screenCount(0), timeouts(0) {
+    memset(pending, 0, sizeof(pending));
+    memset(stats, 0, sizeof(stats));
+  }
+
+  // Link an input to the area that must be redrawn to reflect it.
+  void arm(InputKind kind, uint32_t inputUs, const void *screen, int16_t x1,
+           int16_t y1, int16_t x2, int16_t y2) {
+    if (!inputUs)
+      return;
+    Pending &p = pending[kind];
+    if (p.active)
+      return; // Measure the first event of a burst
+    p.active = true;
+    p.inputUs = inputUs;
+    p.scr = screen;
+    p.screen = screenSlot(screen);
+    p.x1 = x1;
+    p.y1 = y1;
+    p.x2 = x2;
+    p.y2 = y2;
+  }
+
+  // screen is the one being drawn; a redraw of another screen (the old one
+  // before a load animation starts) never closes a probe.
+  void onFlush(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint32_t nowUs,
+               const void *screen) {
+    for (int k = 0; k < INPUT_KIND_COUNT; k++) {
+      Pending &p = pending[k];
+      if (!p.active)
+        continue;
+      uint32_t latency = nowUs - p.inputUs;
+      if (latency > TIMEOUT_US) {
+        p.active = false;
+        timeouts++;
+        continue;
+      }
+      if (p.scr != screen || p.x1 > x2 || p.x2 < x1 || p.y1 > y2 ||
+          p.y2 < y1)
+        continue;
+      Stats &s = stats[k][p.screen];
+      s.samples[s.next] = latency / 100 > 0xFFFF ? 0xFFFF : latency / 100;
+      s.next = (s.next + 1) % SAMPLES;
+      if (s.count < SAMPLES)
+        s.count++;
+      p.active = false;
+    }
+  }
+
+  void nameScreen(const void *screen, const char *name) {
+    uint8_t slot = screenSlot(screen);
+    names[slot] = name;
+  }
+
+  // Print p50/p95/p99 (ms) for every (kind, screen) with samples.
+  template <typename Printer> void report(Printer &out) {
+    static const char *kindNames[INPUT_KIND_COUNT] = {"encoder", "touch",
+                                                      "button"};
+    char line[96];
+    out.println("Latency (input -> flush), ms:");
+    for (int k = 0; k < INPUT_KIND_COUNT; k++) {
+      for (uint8_t sc = 0; sc < screenCount; sc++) {
+        Stats &s = stats[k][sc];
+        if (!s.count)
+          continue;
+        uint16_t sorted[SAMPLES];
+        memcpy(sorted, s.samples, s.count * sizeof(uint16_t));
+        std::sort(sorted, sorted + s.count);
+        snprintf(line, sizeof(line),
+                 "  %-7s %-10s n=%3u p50=%5.1f p95=%5.1f p99=%5.1f",
+                 kindNames[k], names[sc] ? names[sc] : "?", s.count,
+                 pct(sorted, s.count, 50), pct(sorted, s.count, 95),
+                 pct(sorted, s.count, 99));
+        out.println(line);
+      }
+    }
+    snprintf(line, sizeof(line), "  no-redraw timeouts: %lu",
+             (unsigned long)timeouts);
+    out.println(line);
+  }
+
+private:
+  struct Pending {
+    bool active;
+    uint8_t screen;
+    const void *scr;
+    uint32_t inputUs;
+    int16_t x1, y1, x2, y2;
+  };
+
+  struct Stats {
+    uint16_t samples[SAMPLES]; // Units of 100 us
+    uint16_t next;
+    uint16_t count;
+  };
+
+  Pending pending[INPUT_KIND_COUNT];
+  Stats stats[INPUT_KIND_COUNT][MAX_SCREENS];
+  const void *screens[MAX_SCREENS];
+  const char *names[MAX_SCREENS] = {};
+  uint8_t screenCount;
+  uint32_t timeouts;
+
+  uint8_t screenSlot(const void *screen) {
+    for (uint8_t i = 0; i < screenCount; i++)
+      if (screens[i] == screen)
+        return i;
+    if (screenCount < MAX_SCREENS) {
+      screens[screenCount] = screen;
+      return screenCount++;
+    }
+    return MAX_SCREENS - 1; // Overflow bucket
+  }
+
+  static float pct(const uint16_t *sorted, uint16_t n, int p) {
+    uint16_t idx = (uint32_t)(n - 1) * p / 100;
+    return sorted[idx] / 10.0f;
+  }
+};
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include "EventBus.h"
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Asynchronous logger.
+// Callers format into a fixed-size line and post it to a lock-free bus;
+// a low-priority task drains the bus to the serial port. A full bus drops
+// the line (and counts it) instead of waiting, so logging never blocks the
+// caller on a host that is not reading USB CDC.
+// Levels above LOG_MAX_LEVEL are compiled out entirely; below that each
+// module has its own runtime level.
+
+#define LOG_LVL_NONE 0
+#define LOG_LVL_ERROR 1
+#define LOG_LVL_WARN 2
+#define LOG_LVL_INFO 3
+#define LOG_LVL_DEBUG 4
+
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL LOG_LVL_INFO
+#endif
+
+enum LogModule { LOG_SYS, LOG_NET, LOG_UI, LOG_SESSION, LOG_MODULE_COUNT };
+
+typedef uint32_t (*LogClock)();
+
+struct LogLine {
+  uint32_t ms;
+  uint8_t module;
+  uint8_t level;
+  char text[90];
+};
+
+class Logger {
+public:
+  explicit Logger(LogClock clock) : clock(clock), reportedDrops(0) {
+    for (uint8_t i = 0; i < LOG_MODULE_COUNT; i++)
+      levels[i] = LOG_MAX_LEVEL;
+  }
+
+  void setLevel(uint8_t module, uint8_t level) {
+    if (module < LOG_MODULE_COUNT)
+      levels[module] = level;
+  }
+
+  bool enabled(uint8_t module, uint8_t level) const {
+    return module < LOG_MODULE_COUNT && level <= levels[module];
+  }
+
+  // Any task or core. Long messages are truncated.
+  void write(uint8_t module, uint8_t level, const char *fmt, ...)
+      __attribute__((format(printf, 4, 5))) {
+    if (!enabled(module, level))
+      return;
+    LogLine line;
+    line.ms = clock();
+    line.module = module;
+    line.level = level;
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(line.text, sizeof(line.text), fmt, args);
+    va_end(args);
+    lines.post(line);
+  }
+
+  // Drain task only. Returns the number of lines written.
+  template <typename Printer> uint32_t drain(Printer &out) {
+    static const char *const MODULES[LOG_MODULE_COUNT] = {"SYS", "NET", "UI",
+                                                          "SES"};
+    static const char LEVELS[] = "-EWID";
+    char buf[sizeof(LogLine::text) + 24];
+    LogLine line;
+    uint32_t n = 0;
+    while (lines.poll(line)) {
+      snprintf(buf, sizeof(buf), "[%7lu] %c %-3s %s", (unsigned long)line.ms,
+               LEVELS[line.level < 5 ? line.level : 0], MODULES[line.module],
+               line.text);
+      out.println(buf);
+      n++;
+    }
+    uint32_t drops = lines.dropped();
+    if (drops != reportedDrops) {
+      snprintf(buf, sizeof(buf), "[log] %lu lines dropped",
+               (unsigned long)(drops - reportedDrops));
+      out.println(buf);
+      reportedDrops = drops;
+    }
+    return n;
+  }
+
+  uint32_t dropped() const { return lines.dropped(); }
+  uint32_t highWater() const { return lines.highWater(); }
+
+private:
+  LogClock clock;
+  uint8_t levels[LOG_MODULE_COUNT];
+  uint32_t reportedDrops;
+  EventBus<LogLine, 32> lines;
+};
+
+extern Logger logger;
+
+#if LOG_MAX_LEVEL >= LOG_LVL_ERROR
+#define LOGE(mod, ...) logger.write(mod, LOG_LVL_ERROR, __VA_ARGS__)
+#else
+#define LOGE(mod, ...) do {} while (0)
+#endif
+
+#if LOG_MAX_LEVEL >= LOG_LVL_WARN
+#define LOGW(mod, ...) logger.write(mod, LOG_LVL_WARN, __VA_ARGS__)
+#else
+#define LOGW(mod, ...) do {} while (0)
+#endif
+
+#if LOG_MAX_LEVEL >= LOG_LVL_INFO
+#define LOGI(mod, ...) logger.write(mod, LOG_LVL_INFO, __VA_ARGS__)
+#else
+#define LOGI(mod, ...) do {} while (0)
+#endif
+
+#if LOG_MAX_LEVEL >= LOG_LVL_DEBUG
+#define LOGD(mod, ...) logger.write(mod, LOG_LVL_DEBUG, __VA_ARGS__)
+#else
+#define LOGD(mod, ...) do {} while (0)
+#endif
+
+// Printer for the engines' report(out): each line becomes an info line, so
+// a report made from the UI loop is written out by the log task.
+class LogPrinter {
+public:
+  explicit LogPrinter(uint8_t module) : module(module) {}
+  void println(const char *s) { LOGI(module, "%s", s); }
+
+private:
+  uint8_t module;
+};
+
+#endif
@@ -1,14 +1,16 @@
 #ifndef READER_ENGINE_H
 #define READER_ENGINE_H
 
+#include "HidActionQueue.h"
+#include "Sounds.h"
 #include "lvgl.h"
 #include <Arduino.h>
 #include <BleMouse.h>
 
 extern BleMouse bleMouse;
-extern BleMouse bleMouse;
-extern void playTone(int freq, int duration); // Reuse buzzer
+extern void playSound(const BuzzerPattern &p); // Reuse buzzer (non-blocking)
 extern bool encoder_has_focus;                // Task 1: Reference Global
+extern void heap_ble_starting(); // Heap accounting estimates BLE usage
 
 class ReaderEngine {
 public:
@@ -39,7 +41,7 @@ public:
     lv_obj_align(modeLabel, LV_ALIGN_CENTER, 0, -20);
 
     modeSubLabel = lv_label_create(readerLayer);
-    lv_label_set_text(modeSubLabel, "Tap Knob to Lock");
+    lv_label_set_text(modeSubLabel, "Hold Knob to Lock");
     lv_obj_set_style_text_font(modeSubLabel, &ui_font_Subtitle, 0);
     lv_obj_align_to(modeSubLabel, modeLabel, LV_ALIGN_OUT_BOTTOM_MID, 0, 10);
 
@@ -75,6 +77,7 @@ public:
     isActive = true;
     isScrollMode = false;
     lastActivityTime = millis(); // Reset timer on entry
+    showLink(bleMouse.isConnected());
     updateVisuals();
   }
 
@@ -87,11 +90,21 @@ public:
   }
 
   void update() {
+    uint32_t currentMillis = millis();
+
+    // Queued HID reports keep flowing after leaving the app so a pending
+    // cursor return still completes. A new connection starts from a host
+    // cursor we haven't moved.
+    if (bleMouse.isConnected()) {
+      hidQueue.advance(currentMillis, bleMouse);
+    } else {
+      hidQueue.clear();
+      isCursorOffset = false;
+    }
+
     if (!isActive)
       return;
 
-    uint32_t currentMillis = millis();
-
     // 0. Delayed Cursor Kick Logic (Task Fix)
     if (kickPending && currentMillis > kickTimer) {
       if (bleMouse.isConnected() && isScrollMode) {
@@ -131,7 +144,13 @@ public:
           if (abs(final_amount) < 2) {
             final_amount = (final_amount > 0) ? 2 : -2;
           }
-          bleMouse.move(0, 0, final_amount);
+          if (final_amount > 127) // One wheel report is a signed byte
+            final_amount = 127;
+          else if (final_amount < -127)
+            final_amount = -127;
+          // Queued so it can't land inside a kick or shake sequence
+          hidQueue.then(currentMillis, 0, 0, 0, final_amount);
+          hidQueue.advance(currentMillis, bleMouse);
         }
 
         accumulatedTicks = 0;
@@ -145,42 +164,25 @@ public:
         isScrollMode = false;                          // Auto-unlock
         encoder_has_focus = false;                     // Release Focus
         resetCursorPosition(); // Reset cursor on timeout
-        playTone(200, 500);    // Long low buzz to indicate timeout
+        playSound(SND_TIMEOUT); // Long low buzz to indicate timeout
         updateVisuals();
       }
     }
+  }
 
-    // Connection Monitor (Polled)
-    static uint32_t lastCheck = 0;
-    if (currentMillis - lastCheck > 500) { // Check every 500ms
-      bool connected = bleMouse.isConnected();
-      static bool lastConnected = false;
-
-      // Update Header
-      if (connected) {
-        lv_label_set_text(headerLabel, LV_SYMBOL_BLUETOOTH " Connected");
-        lv_obj_set_style_text_color(headerLabel, lv_color_hex(0x00FF00),
-                                    0); // Green
-      } else {
-        lv_label_set_text(headerLabel, "Waiting for Host...");
-        lv_obj_set_style_text_color(headerLabel, lv_color_hex(0xFF5555),
-                                    0); // Redish
-      }
-
-      // Detect State Change to force UI refresh (Fixes "Connecting..." stuck
-      // issue)
-      if (connected != lastConnected) {
-        lastConnected = connected;
-        updateVisuals();
-
-        // Fix: Trigger Delayed Cursor Kick
-        if (connected && isScrollMode) {
-          kickPending = true;
-          kickTimer = currentMillis + 1000; // 1000ms delay for host readiness
-        }
-      }
-
-      lastCheck = currentMillis;
+  // BLE host came or went, from the sketch's link poll via the UI bus.
+  // Replaces polling the link from update(), which also redrew the header
+  // every 500 ms.
+  void onBleLink(bool connected) {
+    if (!isActive)
+      return; // onAppEnter() shows the link as it is then
+    showLink(connected);
+    updateVisuals(); // Fixes "Connecting..." stuck issue
+
+    // Fix: Trigger Delayed Cursor Kick
+    if (connected && isScrollMode) {
+      kickPending = true;
+      kickTimer = millis() + 1000; // 1000ms delay for host readiness
     }
   }
 
@@ -204,7 +206,12 @@ public:
   }
 
   bool getIsActive() { return isActive; }
+  // update() has work: the app is open or HID reports are still queued
+  bool needsUpdate() const { return isActive || !hidQueue.idle(); }
+  const HidActionQueue<BleMouse> &hid() const { return hidQueue; }
   bool getIsScrollMode() { return isScrollMode; }
+  // Redrawn when a long press toggles the mode
+  lv_obj_t *getModeLabel() { return modeLabel; }
 
 private:
   bool isActive;
@@ -222,6 +229,7 @@ private:
   bool kickPending;
   uint32_t kickTimer;
   bool isCursorOffset;
+  HidActionQueue<BleMouse> hidQueue;
 
   lv_obj_t *readerLayer;
   lv_obj_t *headerLabel;
@@ -231,6 +239,18 @@ private:
   lv_obj_t *speedLabel;
   lv_obj_t *invertBtn;
 
+  void showLink(bool connected) {
+    if (connected) {
+      lv_label_set_text(headerLabel, LV_SYMBOL_BLUETOOTH " Connected");
+      lv_obj_set_style_text_color(headerLabel, lv_color_hex(0x00FF00),
+                                  0); // Green
+    } else {
+      lv_label_set_text(headerLabel, "Waiting for Host...");
+      lv_obj_set_style_text_color(headerLabel, lv_color_hex(0xFF5555),
+                                  0); // Redish
+    }
+  }
+
   void updateVisuals() {
     if (isScrollMode) {
       if (bleMouse.isConnected()) {
@@ -252,7 +272,7 @@ private:
     } else {
       lv_label_set_text(modeLabel, "NAV MODE");
       lv_obj_set_style_text_color(modeLabel, lv_color_hex(0x888888), 0); // Grey
-      lv_label_set_text(modeSubLabel, "Tap Knob to Lock");
+      lv_label_set_text(modeSubLabel, "Hold Knob to Lock");
       // Fade out settings to imply they are for the active mode?
       // Actually keep them visible so user can config before locking
       lv_obj_set_style_opa(speedBtn, LV_OPA_80, 0);
@@ -264,6 +284,7 @@ public:
   void startBluetooth() {
     if (hasBleStarted)
       return;
+    heap_ble_starting();
     bleMouse.begin();
     hasBleStarted = true;
   }
@@ -283,9 +304,7 @@ public:
       encoder_has_focus = true; // Task 1: Lock Focus
 
       // Buzz: High-High for active
-      playTone(1000, 50);
-      delay(50);
-      playTone(1200, 50);
+      playSound(SND_LOCK);
 
       // CURSOR KICK (Only if connected, otherwise we wait for delayed kick)
       if (bleMouse.isConnected()) {
@@ -294,7 +313,7 @@ public:
     } else {
       encoder_has_focus = false; // Task 1: Unlock Focus
 
-      playTone(500, 100);
+      playSound(SND_UNLOCK);
       // Return cursor to prevent drift
       resetCursorPosition();
     }
@@ -305,16 +324,14 @@ public:
     if (isCursorOffset)
       return; // Prevent drift by only kicking once per session
 
-    // Strong Kick (Task 2: Deeper move)
-    bleMouse.move(100, 100, 0);
-    delay(50);
-    bleMouse.move(100, 100, 0); // Total 200, 200
-    delay(50);
+    // Strong Kick (Task 2: Deeper move), 50ms apart
+    uint32_t now = millis();
+    hidQueue.then(now, 0, 100, 100);
+    hidQueue.then(now, 50, 100, 100); // Total 200, 200
 
     // Scroll Shake (Task 2: Vigorously wake)
-    bleMouse.move(0, 0, -2);
-    delay(50);
-    bleMouse.move(0, 0, 2);
+    hidQueue.then(now, 50, 0, 0, -2);
+    hidQueue.then(now, 50, 0, 0, 2);
 
     isCursorOffset = true;
   }
@@ -325,10 +342,10 @@ public:
       return;
     }
 
-    // Return to origin (Fixes drift)
-    bleMouse.move(-100, -100, 0);
-    delay(50);
-    bleMouse.move(-100, -100, 0);
+    // Return to origin (Fixes drift), queued behind any pending kick
+    uint32_t now = millis();
+    hidQueue.then(now, 0, -100, -100);
+    hidQueue.then(now, 50, -100, -100);
 
     isCursorOffset = false;
   }
@@ -0,0 +1,244 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Deadline scheduler for the UI loop.
+// Periodic and one-shot jobs live in a fixed table ordered by a binary
+// min-heap on their due time. runDue() runs every job whose deadline has
+// passed, once, and returns the time until the next one, so the caller can
+// block instead of spinning. Times are in microseconds of a caller-supplied clock
+// (micros() on device) and compared wrap-safe.
+// Per job it tracks run count and lateness (jitter); the caller reports
+// time spent blocked via addIdle() for the CPU idle percentage.
+
+typedef void (*JobFn)(void *arg);
+
+class Scheduler {
+public:
+  static const uint8_t MAX_JOBS = 16;
+  static const uint32_t NO_JOB = 0xFFFFFFFF;
+
+  Scheduler()
+      : heapSize(0), jobCount(0), running(-1), idleUs(0), windowStart(0) {}
+
+  // Periodic job, first run at firstDue. Returns job id or -1 if full.
+  int8_t every(const char *name, uint32_t periodUs, JobFn fn, void *arg,
+               uint32_t firstDue) {
+    return add(name, periodUs, fn, arg, firstDue);
+  }
+
+  // One-shot job. The slot is released after it runs.
+  int8_t once(const char *name, JobFn fn, void *arg, uint32_t due) {
+    return add(name, 0, fn, arg, due);
+  }
+
+  // Move a job's next deadline (also valid from inside the job itself, in
+  // which case the normal period step is skipped).
+  void reschedule(int8_t id, uint32_t due) {
+    if (id < 0 || id >= jobCount || !jobs[id].used)
+      return;
+    jobs[id].due = due;
+    if (id == running) {
+      jobs[id].rescheduled = true;
+      return;
+    }
+    if (jobs[id].heapPos >= 0) {
+      siftUp(jobs[id].heapPos);
+      siftDown(jobs[id].heapPos);
+    } else {
+      push(id);
+    }
+  }
+
+  void cancel(int8_t id) {
+    if (id < 0 || id >= jobCount || !jobs[id].used)
+      return;
+    if (jobs[id].heapPos >= 0)
+      removeAt(jobs[id].heapPos);
+    jobs[id].used = false;
+  }
+
+  // Run the jobs that are due, each at most once: a job that reschedules
+  // itself (or another) to "now" waits for the next call instead of
+  // spinning here. Returns microseconds until the next deadline (0 if one
+  // is already due, NO_JOB if nothing is scheduled). now is re-read through
+  // clock after each job so long jobs don't make the next ones look early.
+  template <typename Clock> uint32_t runDue(Clock clock) {
+    uint32_t now = clock();
+    uint32_t ran = 0, again = 0; // Bit per job id
+    while (heapSize && !before(now, jobs[heap[0]].due)) {
+      int8_t id = heap[0];
+      removeAt(0);
+      Job &j = jobs[id];
+      if (ran & (1UL << id)) {
+        again |= 1UL << id; // Due again already: next call
+        continue;
+      }
+      ran |= 1UL << id;
+
+      uint32_t late = now - j.due;
+      j.runs++;
+      j.lateSum += late;
+      if (late > j.lateMax)
+        j.lateMax = late;
+
+      running = id;
+      j.rescheduled = false;
+      j.fn(j.arg);
+      running = -1;
+      now = clock();
+
+      if (!j.used)
+        continue; // Cancelled itself
+      if (j.rescheduled) {
+        push(id);
+      } else if (j.period) {
+        j.due += j.period;
+        if (before(j.due, now)) // Fell behind: skip missed runs
+          j.due = now + j.period;
+        push(id);
+      } else {
+        j.used = false;
+      }
+    }
+    for (uint8_t id = 0; id < jobCount; id++)
+      if ((again & (1UL << id)) && jobs[id].used && jobs[id].heapPos < 0)
+        push(id); // Unless a reschedule() queued it meanwhile
+    return heapSize ? (before(now, jobs[heap[0]].due) ? jobs[heap[0]].due - now
+                                                      : 0)
+                    : NO_JOB;
+  }
+
+  void addIdle(uint32_t us) { idleUs += us; }
+
+  // Idle share of the window since the last call, in percent.
+  float takeIdlePercent(uint32_t now) {
+    uint32_t window = now - windowStart;
+    float pct = window ? 100.0f * idleUs / window : 0.0f;
+    windowStart = now;
+    idleUs = 0;
+    return pct;
+  }
+
+  template <typename Printer> void report(Printer &out) {
+    char line[96];
+    out.println("Jobs (lateness in ms):");
+    for (uint8_t i = 0; i < jobCount; i++) {
+      Job &j = jobs[i];
+      if (!j.used || !j.runs)
+        continue;
+      snprintf(line, sizeof(line), "  %-12s runs=%6lu avg=%6.2f max=%6.2f",
+               j.name, (unsigned long)j.runs,
+               (float)j.lateSum / j.runs / 1000.0f, j.lateMax / 1000.0f);
+      out.println(line);
+      j.runs = 0;
+      j.lateSum = 0;
+      j.lateMax = 0;
+    }
+  }
+
+private:
+  struct Job {
+    const char *name;
+    JobFn fn;
+    void *arg;
+    uint32_t period; // 0 = one-shot
+    uint32_t due;
+    int8_t heapPos;  // -1 when not queued
+    bool used;
+    bool rescheduled;
+    uint32_t runs;
+    uint64_t lateSum;
+    uint32_t lateMax;
+  };
+
+  Job jobs[MAX_JOBS];
+  int8_t heap[MAX_JOBS];
+  uint8_t heapSize;
+  uint8_t jobCount;
+  int8_t running;
+  uint32_t idleUs;
+  uint32_t windowStart;
+
+  static bool before(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+
+  int8_t add(const char *name, uint32_t period, JobFn fn, void *arg,
+             uint32_t due) {
+    int8_t id = -1;
+    for (uint8_t i = 0; i < jobCount; i++)
+      if (!jobs[i].used) {
+        id = i;
+        break;
+      }
+    if (id < 0) {
+      if (jobCount >= MAX_JOBS)
+        return -1;
+      id = jobCount++;
+    }
+    Job &j = jobs[id];
+    j.name = name;
+    j.fn = fn;
+    j.arg = arg;
+    j.period = period;
+    j.due = due;
+    j.heapPos = -1;
+    j.used = true;
+    j.rescheduled = false;
+    j.runs = 0;
+    j.lateSum = 0;
+    j.lateMax = 0;
+    push(id);
+    return id;
+  }
+
+  void place(uint8_t pos, int8_t id) {
+    heap[pos] = id;
+    jobs[id].heapPos = pos;
+  }
+
+  void push(int8_t id) {
+    place(heapSize, id);
+    siftUp(heapSize++);
+  }
+
+  void removeAt(uint8_t pos) {
+    jobs[heap[pos]].heapPos = -1;
+    if (--heapSize == pos)
+      return;
+    place(pos, heap[heapSize]);
+    siftUp(pos);
+    siftDown(jobs[heap[pos]].heapPos);
+  }
+
+  void siftUp(uint8_t pos) {
+    while (pos > 0) {
+      uint8_t parent = (pos - 1) / 2;
+      if (!before(jobs[heap[pos]].due, jobs[heap[parent]].due))
+        break;
+      int8_t tmp = heap[parent];
+      place(parent, heap[pos]);
+      place(pos, tmp);
+      pos = parent;
+    }
+  }
+
+  void siftDown(uint8_t pos) {
+    for (;;) {
+      uint8_t l = pos * 2 + 1, r = l + 1, m = pos;
+      if (l < heapSize && before(jobs[heap[l]].due, jobs[heap[m]].due))
+        m = l;
+      if (r < heapSize && before(jobs[heap[r]].due, jobs[heap[m]].due))
+        m = r;
+      if (m == pos)
+        break;
+      int8_t tmp = heap[m];
+      place(m, heap[pos]);
+      place(pos, tmp);
+      pos = m;
+    }
+  }
+};
+
+#endif
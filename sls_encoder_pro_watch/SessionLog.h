@@ -0,0 +1,218 @@
+#ifndef SESSION_LOG_H
+#define SESSION_LOG_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Input session recorder / replayer.
+// Records timestamped touch, encoder and button events into a compact
+// binary log held in a caller-supplied buffer:
+//
+//   header : 'D' 'P' 'S' version
+//   record : varint dt_ms | type | payload
+//            TOUCH   x:u16 y:u16      (pressed sample)
+//            RELEASE -                (touch up)
+//            ENCODER delta:i8
+//            BUTTON  pressed:u8
+//
+// Replay hands records back once the replay clock reaches their time. The
+// caller owns the clock (millis() on device, a virtual counter on a host),
+// so the same log drives identical input sequences across firmware builds.
+// Network and BLE state are not inputs a replay can drive, so they are not
+// logged (version 1 logs carried them and are refused).
+
+enum SessionRecordType {
+  REC_TOUCH = 1,
+  REC_RELEASE,
+  REC_ENCODER,
+  REC_BUTTON
+};
+
+struct SessionRecord {
+  uint32_t time; // ms since start of session
+  uint8_t type;
+  int16_t a, b;
+};
+
+class SessionLog {
+public:
+  static const uint8_t VERSION = 2;
+
+  SessionLog()
+      : buf(NULL), cap(0), len(0), pos(0), recording(false),
+        replaying(false), overflow(false), startTime(0), lastTime(0) {}
+
+  void attach(uint8_t *buffer, uint32_t capacity) {
+    buf = buffer;
+    cap = capacity;
+    len = 0;
+  }
+
+  // --- Recording ---
+
+  bool startRecording(uint32_t now) {
+    if (!buf || cap < 4 || replaying)
+      return false;
+    buf[0] = 'D';
+    buf[1] = 'P';
+    buf[2] = 'S';
+    buf[3] = VERSION;
+    len = 4;
+    startTime = lastTime = now;
+    overflow = false;
+    recording = true;
+    return true;
+  }
+
+  void stopRecording() { recording = false; }
+
+  void record(uint32_t now, SessionRecordType type, int16_t a = 0,
+              int16_t b = 0) {
+    if (!recording)
+      return;
+    if (type == REC_ENCODER && (a > 127 || a < -128)) {
+      // Split large jumps so the payload stays one byte
+      int16_t part = a > 0 ? 127 : -128;
+      record(now, type, part);
+      record(now, type, a - part);
+      return;
+    }
+
+    uint8_t tmp[10];
+    uint8_t n = 0;
+    uint32_t dt = (int32_t)(now - lastTime) > 0 ? now - lastTime : 0;
+    lastTime += dt;
+    do { // LEB128 varint
+      uint8_t byte = dt & 0x7F;
+      dt >>= 7;
+      tmp[n++] = byte | (dt ? 0x80 : 0);
+    } while (dt);
+    tmp[n++] = type;
+    switch (type) {
+    case REC_TOUCH:
+      tmp[n++] = a & 0xFF;
+      tmp[n++] = (a >> 8) & 0xFF;
+      tmp[n++] = b & 0xFF;
+      tmp[n++] = (b >> 8) & 0xFF;
+      break;
+    case REC_ENCODER:
+    case REC_BUTTON:
+      tmp[n++] = (uint8_t)a;
+      break;
+    default:
+      break;
+    }
+
+    if (len + n > cap) {
+      overflow = true;
+      recording = false; // Keep the log consistent up to this point
+      return;
+    }
+    memcpy(buf + len, tmp, n);
+    len += n;
+  }
+
+  // --- Replay ---
+
+  bool startReplay(uint32_t now) {
+    if (!buf || len < 4 || recording || buf[0] != 'D' || buf[1] != 'P' ||
+        buf[2] != 'S' || buf[3] != VERSION)
+      return false;
+    pos = 4;
+    startTime = now;
+    lastTime = 0;
+    replaying = true;
+    return true;
+  }
+
+  void stopReplay() { replaying = false; }
+
+  // Next record whose time has come, false if none is due yet. Replay ends
+  // by itself after the last record.
+  bool nextDue(uint32_t now, SessionRecord &r) {
+    if (!replaying)
+      return false;
+    if (pos >= len) {
+      replaying = false;
+      return false;
+    }
+
+    uint32_t p = pos;
+    uint32_t dt = 0;
+    uint8_t shift = 0;
+    while (p < len) {
+      uint8_t byte = buf[p++];
+      dt |= (uint32_t)(byte & 0x7F) << shift;
+      shift += 7;
+      if (!(byte & 0x80))
+        break;
+    }
+    if (now - startTime < lastTime + dt)
+      return false;
+
+    r.time = lastTime + dt;
+    r.a = r.b = 0;
+    if (p >= len)
+      return endOfLog();
+    r.type = buf[p++];
+    switch (r.type) {
+    case REC_TOUCH:
+      if (p + 4 > len)
+        return endOfLog();
+      r.a = (int16_t)(buf[p] | (buf[p + 1] << 8));
+      r.b = (int16_t)(buf[p + 2] | (buf[p + 3] << 8));
+      p += 4;
+      break;
+    case REC_ENCODER:
+      if (p + 1 > len)
+        return endOfLog();
+      r.a = (int8_t)buf[p++];
+      break;
+    case REC_BUTTON:
+      if (p + 1 > len)
+        return endOfLog();
+      r.a = buf[p++];
+      break;
+    case REC_RELEASE:
+      break;
+    default:
+      return endOfLog(); // Unknown type: cannot resync
+    }
+    lastTime = r.time;
+    pos = p;
+    return true;
+  }
+
+  // Load a previously dumped log (e.g. from a host file) for replay.
+  bool load(const uint8_t *data, uint32_t n) {
+    if (!buf || n > cap || recording || replaying)
+      return false;
+    memcpy(buf, data, n);
+    len = n;
+    return true;
+  }
+
+  bool isRecording() const { return recording; }
+  bool isReplaying() const { return replaying; }
+  bool overflowed() const { return overflow; }
+  const uint8_t *data() const { return buf; }
+  uint32_t length() const { return len; }
+
+private:
+  uint8_t *buf;
+  uint32_t cap;
+  uint32_t len;
+  uint32_t pos;
+  bool recording;
+  bool replaying;
+  bool overflow;
+  uint32_t startTime;
+  uint32_t lastTime; // Recording: absolute ms; replay: session-relative ms
+
+  bool endOfLog() {
+    replaying = false;
+    return false;
+  }
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <atomic>
+#include <stdint.h>
+
+// Latest-value mailbox: one writer publishes whole copies of a POD struct,
+// any number of readers take consistent copies without locks or allocation.
+// Double-buffered seqlock: the writer fills the slot readers aren't using,
+// then bumps the sequence (odd while a write is in progress, +2 per
+// publish). A reader only retries if the writer published twice during its
+// copy, so it never spins on a single update. Intermediate values may be
+// skipped; readers always see the newest whole one.
+
+template <typename T> class Snapshot {
+public:
+  Snapshot() : seq(0), retryCount(0) { slots[0] = slots[1] = T(); }
+
+  // Writer only: the value last published (safe to read without the lock)
+  const T &last() const {
+    return slots[(seq.load(std::memory_order_relaxed) >> 1) & 1];
+  }
+
+  // Writer only (one task at a time)
+  void publish(const T &v) {
+    uint32_t s = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed); // Odd: write in progress
+    std::atomic_thread_fence(std::memory_order_release);
+    slots[((s >> 1) + 1) & 1] = v;
+    seq.store(s + 2, std::memory_order_release);
+  }
+
+  // Number of values published so far, cheap to poll for a change
+  uint32_t version() const {
+    return seq.load(std::memory_order_acquire) >> 1;
+  }
+
+  // Copies the newest value, returns its version
+  uint32_t read(T &out) const {
+    for (;;) {
+      uint32_t s1 = seq.load(std::memory_order_acquire);
+      out = slots[(s1 >> 1) & 1];
+      std::atomic_thread_fence(std::memory_order_acquire);
+      uint32_t s2 = seq.load(std::memory_order_relaxed);
+      // Our slot is rewritten from the second publish after s1 on
+      if (s2 - (s1 & ~1u) <= 2)
+        return s1 >> 1;
+      retryCount.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  uint32_t retries() const {
+    return retryCount.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<uint32_t> seq;
+  mutable std::atomic<uint32_t> retryCount;
+  T slots[2];
+};
+
+#endif
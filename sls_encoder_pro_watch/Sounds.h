@@ -0,0 +1,36 @@
+#ifndef SOUNDS_H
+#define SOUNDS_H
+
+#include "BuzzerEngine.h"
+
+// Buzzer pattern tables, resolved at compile time.
+#define SOUND_PATTERN(notes, prio)                                             \
+  { notes, sizeof(notes) / sizeof(notes[0]), prio }
+
+// --- Pet ---
+constexpr BuzzerNote SQUEAK_NOTES[] = {{2000, 50}, {2500, 50}};
+constexpr BuzzerNote SNORE_NOTES[] = {{300, 100}};
+constexpr BuzzerNote GROWL_NOTES[] = {{200, 20}, {190, 20}, {180, 20},
+                                      {170, 20}, {160, 20}, {150, 20},
+                                      {140, 20}, {130, 20}, {120, 20},
+                                      {110, 20}};
+
+constexpr BuzzerPattern SND_SQUEAK = SOUND_PATTERN(SQUEAK_NOTES, PRIO_PET);
+constexpr BuzzerPattern SND_SNORE = SOUND_PATTERN(SNORE_NOTES, PRIO_PET);
+constexpr BuzzerPattern SND_GROWL = SOUND_PATTERN(GROWL_NOTES, PRIO_PET);
+
+// --- Reader ---
+// Lock: High-High for active, Unlock: single low beep
+constexpr BuzzerNote LOCK_NOTES[] = {{1000, 50}, {0, 50}, {1200, 50}};
+constexpr BuzzerNote UNLOCK_NOTES[] = {{500, 100}};
+
+constexpr BuzzerPattern SND_LOCK = SOUND_PATTERN(LOCK_NOTES, PRIO_FEEDBACK);
+constexpr BuzzerPattern SND_UNLOCK = SOUND_PATTERN(UNLOCK_NOTES, PRIO_FEEDBACK);
+
+// --- Alerts ---
+// Long low buzz: Reader inactivity timeout
+constexpr BuzzerNote TIMEOUT_NOTES[] = {{200, 500}};
+
+constexpr BuzzerPattern SND_TIMEOUT = SOUND_PATTERN(TIMEOUT_NOTES, PRIO_ALERT);
+
+#endif
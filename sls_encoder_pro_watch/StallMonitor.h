@@ -0,0 +1,227 @@
+#ifndef STALL_MONITOR_H
+#define STALL_MONITOR_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// UI stall detector.
+// loopMark() is called before every lv_timer_handler(); the busy time since
+// the previous mark (idle reported through addIdle() excluded) is how long
+// LVGL was kept waiting. Blocking code is attributed with STALL_SCOPE(tag)
+// markers: each scope records its self time (nested scopes subtracted), and
+// a busy window over the threshold is kept in a top-N list together with
+// the scope that used most of it.
+// Single-threaded (UI task only). Times come from a caller-supplied
+// microsecond clock. Build with -DSTALL_MONITOR=0 to compile scopes out.
+
+#ifndef STALL_MONITOR
+#define STALL_MONITOR 1
+#endif
+
+typedef uint32_t (*StallClock)();
+
+class StallMonitor {
+public:
+  static const uint8_t MAX_TAGS = 16;
+  static const uint8_t TOP_N = 8;
+  static const uint8_t MAX_DEPTH = 8;
+
+  explicit StallMonitor(StallClock clock, uint32_t thresholdUs = 20000)
+      : clock(clock), threshold(thresholdUs), lastMark(0), started(false),
+        idleUs(0), depth(0), tagCount(0), stallCount(0), worstBusy(0) {
+    resetWindow();
+  }
+
+  void loopMark() {
+    uint32_t now = clock();
+    if (started) {
+      uint32_t gap = now - lastMark;
+      uint32_t busy = gap > idleUs ? gap - idleUs : 0;
+      if (busy > worstBusy)
+        worstBusy = busy;
+      if (busy >= threshold)
+        recordStall(now, busy);
+    }
+    started = true;
+    lastMark = now;
+    idleUs = 0;
+    resetWindow();
+  }
+
+  void addIdle(uint32_t us) { idleUs += us; }
+
+  void enter(const char *tag) {
+    if (depth < MAX_DEPTH) {
+      stack[depth].tag = tag;
+      stack[depth].start = clock();
+      stack[depth].childUs = 0;
+    }
+    depth++;
+  }
+
+  void leave() {
+    if (!depth)
+      return;
+    if (--depth >= MAX_DEPTH)
+      return; // Too deep, not tracked
+    Frame &f = stack[depth];
+    uint32_t dur = clock() - f.start;
+    uint32_t self = dur > f.childUs ? dur - f.childUs : 0;
+    if (depth)
+      stack[depth - 1].childUs += dur;
+
+    Tag *t = find(f.tag);
+    if (t) {
+      t->count++;
+      t->totalUs += self;
+      if (self > t->maxUs)
+        t->maxUs = self;
+    }
+    winScopedUs += self;
+    if (self > winTopUs) {
+      winTopUs = self;
+      winTop = f.tag;
+    }
+  }
+
+  // Prints and clears the collected stalls and scope statistics.
+  template <typename Printer> void report(Printer &out) {
+    char line[96];
+    snprintf(line, sizeof(line),
+             "Stalls >= %.1f ms: %lu (worst busy window %.1f ms)",
+             threshold / 1000.0f, (unsigned long)stallCount,
+             worstBusy / 1000.0f);
+    out.println(line);
+    for (uint8_t i = 0; i < TOP_N && top[i].busyUs; i++) {
+      snprintf(line, sizeof(line), "  #%u %7.1f ms @%8lu ms  %s (%.1f ms)",
+               i + 1, top[i].busyUs / 1000.0f, (unsigned long)top[i].atMs,
+               top[i].tag, top[i].tagUs / 1000.0f);
+      out.println(line);
+    }
+    out.println("Scopes (self time in ms):");
+    for (uint8_t i = 0; i < tagCount; i++) {
+      Tag &t = tags[i];
+      if (!t.count)
+        continue;
+      snprintf(line, sizeof(line), "  %-10s n=%7lu avg=%6.2f max=%7.2f",
+               t.name, (unsigned long)t.count,
+               (float)t.totalUs / t.count / 1000.0f, t.maxUs / 1000.0f);
+      out.println(line);
+      t.count = 0;
+      t.totalUs = 0;
+      t.maxUs = 0;
+    }
+    for (uint8_t i = 0; i < TOP_N; i++)
+      top[i].busyUs = 0;
+    stallCount = 0;
+    worstBusy = 0;
+  }
+
+private:
+  struct Frame {
+    const char *tag;
+    uint32_t start;
+    uint32_t childUs;
+  };
+
+  struct Tag {
+    const char *name;
+    uint32_t count;
+    uint64_t totalUs;
+    uint32_t maxUs;
+  };
+
+  struct Stall {
+    uint32_t busyUs; // 0 = empty slot
+    uint32_t atMs;
+    const char *tag;
+    uint32_t tagUs;
+  };
+
+  StallClock clock;
+  uint32_t threshold;
+  uint32_t lastMark;
+  bool started;
+  uint32_t idleUs;
+
+  Frame stack[MAX_DEPTH];
+  uint8_t depth;
+  Tag tags[MAX_TAGS];
+  uint8_t tagCount;
+  Stall top[TOP_N] = {};
+  uint32_t stallCount;
+  uint32_t worstBusy;
+
+  // Current window (since the last loopMark)
+  const char *winTop;
+  uint32_t winTopUs;
+  uint32_t winScopedUs;
+
+  void resetWindow() {
+    winTop = nullptr;
+    winTopUs = 0;
+    winScopedUs = 0;
+  }
+
+  // Tags are string literals, matched by pointer
+  Tag *find(const char *name) {
+    for (uint8_t i = 0; i < tagCount; i++)
+      if (tags[i].name == name)
+        return &tags[i];
+    if (tagCount == MAX_TAGS)
+      return nullptr;
+    Tag &t = tags[tagCount++];
+    t.name = name;
+    t.count = 0;
+    t.totalUs = 0;
+    t.maxUs = 0;
+    return &t;
+  }
+
+  void recordStall(uint32_t now, uint32_t busy) {
+    stallCount++;
+    Stall s;
+    s.busyUs = busy;
+    s.atMs = now / 1000;
+    // Time outside any scope can be the biggest share too
+    uint32_t untagged = busy > winScopedUs ? busy - winScopedUs : 0;
+    if (untagged > winTopUs) {
+      s.tag = "(untagged)";
+      s.tagUs = untagged;
+    } else {
+      s.tag = winTop;
+      s.tagUs = winTopUs;
+    }
+    // Insert keeping the list sorted, longest first
+    for (uint8_t i = 0; i < TOP_N; i++) {
+      if (busy > top[i].busyUs) {
+        for (uint8_t j = TOP_N - 1; j > i; j--)
+          top[j] = top[j - 1];
+        top[i] = s;
+        return;
+      }
+    }
+  }
+};
+
+class StallScope {
+public:
+  StallScope(StallMonitor &m, const char *tag) : monitor(m) { m.enter(tag); }
+  ~StallScope() { monitor.leave(); }
+
+private:
+  StallMonitor &monitor;
+};
+
+#if STALL_MONITOR
+#define STALL_CAT2(a, b) a##b
+#define STALL_CAT(a, b) STALL_CAT2(a, b)
+#define STALL_SCOPE(tag)                                                       \
+  StallScope STALL_CAT(stall_scope_, __LINE__)(stalls, tag)
+#else
+#define STALL_SCOPE(tag) do {} while (0)
+#endif
+
+extern StallMonitor stalls;
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef TASK_MONITOR_H
+#define TASK_MONITOR_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Per-task CPU share and stack headroom.
+// The caller snapshots the task list (uxTaskGetSystemState() on device)
+// into TaskSample rows and passes them to update() together with the total
+// run-time counter. Shares are computed from counter deltas between two
+// updates, per core: a pinned task's share is its run time over the
+// window, the core load is 100% minus that core's IDLE task. Stack
+// headroom is the FreeRTOS high-water mark (bytes on ESP-IDF).
+// Without run-time stats (the stock Arduino sdkconfig), updateIdle() takes
+// per-core tick counts instead: how many tick interrupts found the IDLE
+// task running. That gives the core loads only, to a tick's resolution.
+// Threshold crossings are flagged once per crossing for the caller to log.
+
+struct TaskSample {
+  uint32_t id; // xTaskNumber, stable for the life of the task
+  const char *name;
+  int8_t core;        // 0, 1 or -1 (not pinned)
+  uint32_t runTime;   // Run-time counter (0 when stats are unavailable)
+  uint32_t stackFree; // Bytes never used
+};
+
+struct TaskStat {
+  uint32_t id;
+  char name[16];
+  int8_t core;
+  uint32_t lastRun;
+  float cpu;          // % of one core over the last window
+  uint32_t stackFree; // High-water mark, only ever shrinks
+  bool stackWarned;
+};
+
+class TaskMonitor {
+public:
+  static const uint8_t MAX_TASKS = 24;
+
+  TaskMonitor(uint32_t stackWarnBytes, float cpuWarnPct)
+      : stackWarn(stackWarnBytes), cpuWarn(cpuWarnPct), count(0), lastTotal(0),
+        windowUs(0), haveRunTime(false), haveIdleTicks(false) {
+    coreLoad[0] = coreLoad[1] = 0;
+    coreWarned[0] = coreWarned[1] = false;
+    lastIdle[0] = lastIdle[1] = lastTicks[0] = lastTicks[1] = 0;
+  }
+
+  // Returns a bit mask of new warnings: bit0 stack, bit1 core 0, bit2 core 1.
+  // Tasks that just crossed the stack threshold have stackWarned set until
+  // the next update().
+  uint8_t update(const TaskSample *samples, uint8_t n, uint32_t totalRunTime) {
+    uint32_t window = totalRunTime - lastTotal;
+    bool first = lastTotal == 0;
+    lastTotal = totalRunTime;
+    windowUs = window;
+    haveRunTime = totalRunTime != 0;
+
+    TaskStat next[MAX_TASKS];
+    uint8_t nextCount = 0;
+    uint8_t warnings = 0;
+    float idle[2] = {-1, -1};
+
+    for (uint8_t i = 0; i < n && nextCount < MAX_TASKS; i++) {
+      const TaskSample &s = samples[i];
+      const TaskStat *prev = find(s.id);
+      TaskStat &t = next[nextCount++];
+      t.id = s.id;
+      strncpy(t.name, s.name ? s.name : "?", sizeof(t.name) - 1);
+      t.name[sizeof(t.name) - 1] = 0;
+      t.core = s.core;
+      t.lastRun = s.runTime;
+      t.cpu = (prev && !first && window)
+                  ? 100.0f * (s.runTime - prev->lastRun) / window
+                  : 0.0f;
+      t.stackFree = s.stackFree;
+      bool wasLow = prev && prev->stackFree < stackWarn;
+      t.stackWarned = s.stackFree < stackWarn && !wasLow;
+      if (t.stackWarned)
+        warnings |= 1;
+      if (!strncmp(t.name, "IDLE", 4) && s.core >= 0 && s.core < 2)
+        idle[s.core] = t.cpu;
+    }
+    memcpy(tasks, next, nextCount * sizeof(TaskStat));
+    count = nextCount;
+
+    if (haveRunTime && !first)
+      for (uint8_t c = 0; c < 2; c++)
+        if (idle[c] >= 0)
+          warnings |= setLoad(c, idle[c]);
+    return warnings;
+  }
+
+  // Cumulative per-core counts of ticks that hit IDLE and of all ticks.
+  // Same warning bits as update(); ignored while run-time stats work.
+  uint8_t updateIdle(const uint32_t idleTicks[2], const uint32_t ticks[2]) {
+    uint8_t warnings = 0;
+    for (uint8_t c = 0; c < 2; c++) {
+      uint32_t window = ticks[c] - lastTicks[c];
+      uint32_t idle = idleTicks[c] - lastIdle[c];
+      bool first = lastTicks[c] == 0;
+      lastTicks[c] = ticks[c];
+      lastIdle[c] = idleTicks[c];
+      if (first || !window || haveRunTime)
+        continue;
+      warnings |= setLoad(c, 100.0f * idle / window);
+      haveIdleTicks = true;
+    }
+    return warnings;
+  }
+
+  uint8_t size() const { return count; }
+  const TaskStat &task(uint8_t i) const { return tasks[i]; }
+  float load(uint8_t core) const { return core < 2 ? coreLoad[core] : 0; }
+
+  template <typename Printer> void report(Printer &out) {
+    char line[96];
+    if (haveRunTime) {
+      snprintf(line, sizeof(line),
+               "Tasks (CPU %% of core over %.1f s, stack free bytes):",
+               windowUs / 1e6f);
+      out.println(line);
+    } else {
+      out.println("Tasks (stack free bytes, run-time stats disabled):");
+    }
+    for (uint8_t i = 0; i < count; i++) {
+      const TaskStat &t = tasks[i];
+      snprintf(line, sizeof(line),
+               "  %-15s core %c  cpu %5.1f%%  stack %6lu%s", t.name,
+               t.core >= 0 ? '0' + t.core : '-', t.cpu,
+               (unsigned long)t.stackFree,
+               t.stackFree < stackWarn ? "  LOW" : "");
+      out.println(line);
+    }
+    if (haveRunTime || haveIdleTicks) {
+      snprintf(line, sizeof(line), "  load: core0 %.1f%%  core1 %.1f%%%s",
+               coreLoad[0], coreLoad[1],
+               haveRunTime ? "" : "  (sampled idle ticks)");
+      out.println(line);
+    }
+  }
+
+private:
+  uint32_t stackWarn;
+  float cpuWarn;
+  TaskStat tasks[MAX_TASKS];
+  uint8_t count;
+  uint32_t lastTotal;
+  uint32_t windowUs;
+  bool haveRunTime;
+  bool haveIdleTicks;
+  float coreLoad[2];
+  bool coreWarned[2];
+  uint32_t lastIdle[2];
+  uint32_t lastTicks[2];
+
+  uint8_t setLoad(uint8_t c, float idlePct) {
+    coreLoad[c] = 100.0f - idlePct;
+    bool high = coreLoad[c] >= cpuWarn;
+    uint8_t warn = high && !coreWarned[c] ? 2 << c : 0;
+    coreWarned[c] = high;
+    return warn;
+  }
+
+  const TaskStat *find(uint32_t id) const {
+    for (uint8_t i = 0; i < count; i++)
+      if (tasks[i].id == id)
+        return &tasks[i];
+    return nullptr;
+  }
+};
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef TIME_KEEPER_H
+#define TIME_KEEPER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Wall clock persistence and how far it can be trusted.
+// The caller keeps a TimeRecord in RTC memory (survives resets and deep
+// sleep; the system clock usually keeps counting too) and in NVS (survives
+// power loss, but not the time spent off). At boot restore() picks the best
+// of the running clock, the RTC copy and the NVS copy, before anything
+// draws the time.
+// Confidence follows the estimated error: time since the last network sync
+// times the clock's drift (the measured one, at least driftFloorPpm).
+// After power loss the saved time is behind by however long the watch was
+// off, so it never becomes the clock: the clock stays unset until a sync,
+// and the saved time is only the earliest one a sync may report (floor()).
+
+enum TimeConfidence {
+  TIME_CONF_NONE,   // 1970
+  TIME_CONF_LOW,    // Error unknown
+  TIME_CONF_MEDIUM, // Error below mediumErrMs
+  TIME_CONF_HIGH,   // Error below highErrMs: no need to sync for time
+};
+
+enum TimeOrigin { TIME_FROM_NONE, TIME_FROM_CLOCK, TIME_FROM_NVS };
+
+struct TimeRecord {
+  uint32_t magic;
+  uint32_t savedEpoch; // Wall clock when written
+  uint32_t syncEpoch;  // Last network sync, 0 if never
+  float driftPpm;      // Measured, 0 if unknown
+  uint32_t check;      // Rejects stale or uninitialised RTC memory
+};
+
+class TimeKeeper {
+public:
+  static const uint32_t EPOCH_VALID = 1600000000; // After 2020
+  static const uint32_t MAGIC = 0x54494D31;       // "TIM1"
+
+  TimeKeeper(uint32_t highErrMs, uint32_t mediumErrMs, float driftFloorPpm)
+      : highErr(highErrMs), mediumErr(mediumErrMs), driftFloor(driftFloorPpm),
+        origin(TIME_FROM_NONE), noRecord(false), syncEpoch(0), drift(0),
+        floorEpoch(0) {}
+
+  // At boot. clockEpoch: time() right now. Leaves the clock as it is: a
+  // running clock is kept, a saved time only sets floor().
+  void restore(const TimeRecord &rtc, const TimeRecord &nvs,
+               uint32_t clockEpoch) {
+    bool rtcOk = valid(rtc);
+    bool nvsOk = valid(nvs);
+    if (clockEpoch >= EPOCH_VALID) {
+      // Reset or wake-up: the clock kept running, RTC memory knows its sync
+      origin = TIME_FROM_CLOCK;
+      const TimeRecord *r = rtcOk ? &rtc : nvsOk ? &nvs : nullptr;
+      if (r && r->syncEpoch <= clockEpoch)
+        adopt(*r);
+      noRecord = !r;
+      return;
+    }
+    // Power loss: the newest saved time is all we know
+    const TimeRecord *r = nullptr;
+    if (rtcOk && (!nvsOk || rtc.savedEpoch >= nvs.savedEpoch))
+      r = &rtc;
+    else if (nvsOk)
+      r = &nvs;
+    if (!r)
+      return;
+    drift = r->driftPpm; // Still this crystal; the sync age is unknown
+    origin = TIME_FROM_NVS;
+    floorEpoch = r->savedEpoch;
+  }
+
+  // The clock was just set from the network
+  void synced(uint32_t epoch, float driftPpm) {
+    syncEpoch = epoch;
+    if (driftPpm != 0)
+      drift = driftPpm;
+    noRecord = false;
+  }
+
+  TimeRecord record(uint32_t epoch) const {
+    TimeRecord r;
+    r.magic = MAGIC;
+    r.savedEpoch = epoch;
+    r.syncEpoch = syncEpoch;
+    r.driftPpm = drift;
+    r.check = checksum(r);
+    return r;
+  }
+
+  // Estimated error in ms, UINT32_MAX if unknown
+  uint32_t errorMs(uint32_t epoch) const {
+    if (epoch < EPOCH_VALID || noRecord || !syncEpoch || epoch < syncEpoch)
+      return UINT32_MAX;
+    double ppm = ppmBound();
+    double err = (double)(epoch - syncEpoch) * ppm / 1000.0; // s*ppm -> ms
+    return err > 4e9 ? UINT32_MAX : (uint32_t)err;
+  }
+
+  TimeConfidence confidence(uint32_t epoch) const {
+    if (epoch < EPOCH_VALID)
+      return TIME_CONF_NONE;
+    uint32_t err = errorMs(epoch);
+    if (err < highErr)
+      return TIME_CONF_HIGH;
+    if (err < mediumErr)
+      return TIME_CONF_MEDIUM;
+    return TIME_CONF_LOW;
+  }
+
+  // Seconds until confidence drops below HIGH (0: already)
+  uint32_t secondsOfHigh(uint32_t epoch) const {
+    if (confidence(epoch) != TIME_CONF_HIGH)
+      return 0;
+    double total = highErr * 1000.0 / ppmBound(); // ms / ppm -> s
+    double left = total - (double)(epoch - syncEpoch);
+    return left > 0 ? (uint32_t)left : 0;
+  }
+
+  TimeOrigin restoredFrom() const { return origin; }
+  // Saved time from before power loss, 0 if none: a sync reporting an
+  // earlier time is wrong
+  uint32_t floor() const { return floorEpoch; }
+
+  template <typename Printer> void report(Printer &out, uint32_t epoch) const {
+    static const char *conf[] = {"none", "low", "medium", "high"};
+    static const char *from[] = {"nothing", "running clock",
+                                 "saved time (floor only)"};
+    char line[112];
+    uint32_t err = errorMs(epoch);
+    char errText[16];
+    if (err == UINT32_MAX)
+      snprintf(errText, sizeof(errText), "unknown");
+    else
+      snprintf(errText, sizeof(errText), "%lums", (unsigned long)err);
+    snprintf(line, sizeof(line),
+             "  confidence %s (error %s), restored from %s, drift %.1fppm",
+             conf[confidence(epoch)], errText, from[origin], drift);
+    out.println(line);
+    if (syncEpoch && epoch >= syncEpoch) {
+      snprintf(line, sizeof(line),
+               "  last sync %lus ago, high confidence for %lus more",
+               (unsigned long)(epoch - syncEpoch),
+               (unsigned long)secondsOfHigh(epoch));
+      out.println(line);
+    }
+  }
+
+private:
+  uint32_t highErr;
+  uint32_t mediumErr;
+  float driftFloor;
+  TimeOrigin origin;
+  bool noRecord; // Clock kept running, but nothing says when it was synced
+  uint32_t syncEpoch;
+  float drift;
+  uint32_t floorEpoch;
+
+  double ppmBound() const {
+    double d = drift < 0 ? -drift : drift;
+    return d > driftFloor ? d : driftFloor;
+  }
+
+  void adopt(const TimeRecord &r) {
+    syncEpoch = r.syncEpoch;
+    drift = r.driftPpm;
+  }
+
+  static uint32_t checksum(const TimeRecord &r) {
+    uint32_t d;
+    memcpy(&d, &r.driftPpm, sizeof(d));
+    uint32_t h = 2166136261u; // FNV-1a over the words
+    const uint32_t words[] = {r.magic, r.savedEpoch, r.syncEpoch, d};
+    for (uint8_t i = 0; i < 4; i++)
+      h = (h ^ words[i]) * 16777619u;
+    return h;
+  }
+
+  static bool valid(const TimeRecord &r) {
+    return r.magic == MAGIC && r.check == checksum(r) &&
+           r.savedEpoch >= EPOCH_VALID;
+  }
+};
+
+#endif
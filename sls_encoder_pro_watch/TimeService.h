@@ -0,0 +1,200 @@
+#ifndef TIME_SERVICE_H
+#define TIME_SERVICE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Wall clock discipline for several time sources racing each other.
+// A sync round starts when the sources are asked (SNTP and an HTTP JSON
+// endpoint, in parallel). Each reply is offered with the local wall clock
+// at the moment it arrived; the first one that passes validation wins the
+// round and is applied, stepping the clock if it is unset or far off,
+// otherwise slewing it (adjtime). Later replies from a more precise source
+// only ever slew. The caller performs the verdict and must serialise
+// offer() calls (replies arrive on different tasks).
+// A reply earlier than the floor (the last time known before power loss,
+// see TimeKeeper) is rejected like one from before 2020.
+// Recorded: time to first valid reply per round, winner per source, and
+// the local clock's drift (offset found at a sync over the time since the
+// previous one).
+
+enum TimeSourceId { TIME_SRC_NTP, TIME_SRC_HTTP, TIME_SRC_COUNT };
+
+enum TimeVerdict {
+  TIME_REJECTED,  // Failed validation
+  TIME_REDUNDANT, // Valid, nothing to correct
+  TIME_STEP,      // settimeofday(now + delta)
+  TIME_SLEW,      // adjtime(delta)
+};
+
+struct TimeReply {
+  uint8_t source;  // TimeSourceId, lower is more precise
+  int64_t refUs;   // Reference epoch time (us) at the moment of arrival
+  int64_t localUs; // Our wall clock (us) at the same moment
+  uint32_t rxMs;   // millis() at arrival
+};
+
+class TimeService {
+public:
+  static const int64_t EPOCH_VALID = 1600000000; // After 2020
+  static const int64_t EPOCH_MAX = 4102444800;   // Before 2100
+
+  TimeService(uint32_t stepThresholdMs, uint32_t maxSlewMs)
+      : stepUs((int64_t)stepThresholdMs * 1000),
+        maxSlewUs((int64_t)maxSlewMs * 1000), floorSec(EPOCH_VALID),
+        synced(false), inRound(false),
+        winner(TIME_SRC_COUNT), roundStartMs(0), lastSyncUs(0),
+        rounds(0), timeouts(0), lastTtfv(0), bestTtfv(UINT32_MAX),
+        worstTtfv(0), rejected(0), steps(0), slews(0), lastDeltaUs(0),
+        driftPpm(0), driftAvgPpm(0), driftSamples(0) {
+    for (uint8_t i = 0; i < TIME_SRC_COUNT; i++)
+      wins[i] = 0;
+  }
+
+  // Earliest epoch a reply may carry, at boot
+  void setFloor(int64_t epoch) {
+    floorSec = epoch > EPOCH_VALID ? epoch : EPOCH_VALID;
+  }
+
+  // Sources have been asked
+  void startRound(uint32_t nowMs) {
+    roundStartMs = nowMs;
+    inRound = true;
+    winner = TIME_SRC_COUNT;
+    rounds++;
+  }
+
+  // Round over without a valid reply (call once, at the caller's timeout)
+  void endRound() {
+    if (inRound && winner == TIME_SRC_COUNT)
+      timeouts++;
+    inRound = false;
+  }
+
+  bool roundWon() const { return winner != TIME_SRC_COUNT; }
+  // Set by a valid reply since boot
+  bool isSynced() const { return synced; }
+
+  // deltaUs: correction for the caller to apply (STEP / SLEW)
+  TimeVerdict offer(const TimeReply &r, int64_t &deltaUs) {
+    deltaUs = r.refUs - r.localUs;
+    int64_t sec = r.refUs / 1000000;
+    if (r.source >= TIME_SRC_COUNT || sec < floorSec || sec > EPOCH_MAX) {
+      rejected++;
+      return TIME_REJECTED;
+    }
+
+    if (inRound && !roundWon()) {
+      winner = r.source;
+      wins[r.source]++;
+      lastTtfv = r.rxMs - roundStartMs;
+      if (lastTtfv < bestTtfv)
+        bestTtfv = lastTtfv;
+      if (lastTtfv > worstTtfv)
+        worstTtfv = lastTtfv;
+      noteDrift(r, deltaUs);
+      return apply(r, deltaUs, !synced || llabs(deltaUs) >= stepUs);
+    }
+
+    // A later reply (or SNTP's own periodic one between rounds) may only
+    // slew, and inside a round only if it is more precise than the winner
+    if (!synced)
+      return apply(r, deltaUs, true);
+    if (inRound && r.source >= winner)
+      return TIME_REDUNDANT;
+    if (llabs(deltaUs) > maxSlewUs) {
+      rejected++; // Disagrees with the clock more than it could be off
+      return TIME_REJECTED;
+    }
+    if (inRound)
+      winner = r.source;
+    return apply(r, deltaUs, false);
+  }
+
+  int64_t lastCorrectionUs() const { return lastDeltaUs; }
+  float drift() const { return driftAvgPpm; }
+
+  template <typename Printer> void report(Printer &out) const {
+    static const char *names[TIME_SRC_COUNT] = {"ntp", "http"};
+    char line[112];
+    snprintf(line, sizeof(line),
+             "Time: %s, rounds=%lu timeouts=%lu wins ntp=%lu http=%lu",
+             synced ? "synced" : "unset", (unsigned long)rounds,
+             (unsigned long)timeouts, (unsigned long)wins[TIME_SRC_NTP],
+             (unsigned long)wins[TIME_SRC_HTTP]);
+    out.println(line);
+    snprintf(line, sizeof(line),
+             "  time to first valid: last=%lums best=%lums worst=%lums "
+             "(last winner %s)",
+             (unsigned long)lastTtfv,
+             (unsigned long)(bestTtfv == UINT32_MAX ? 0 : bestTtfv),
+             (unsigned long)worstTtfv,
+             winner < TIME_SRC_COUNT ? names[winner] : "-");
+    out.println(line);
+    snprintf(line, sizeof(line),
+             "  steps=%lu slews=%lu rejected=%lu last correction=%lldus",
+             (unsigned long)steps, (unsigned long)slews,
+             (unsigned long)rejected, (long long)lastDeltaUs);
+    out.println(line);
+    snprintf(line, sizeof(line), "  drift: last=%.1fppm avg=%.1fppm (%lu)",
+             driftPpm, driftAvgPpm, (unsigned long)driftSamples);
+    out.println(line);
+  }
+
+private:
+  static const int64_t MIN_DRIFT_SPAN_US = 600000000LL; // 10 mins
+  static const int64_t REDUNDANT_US = 1000;             // Below 1 ms
+
+  int64_t stepUs;
+  int64_t maxSlewUs;
+  int64_t floorSec;
+  bool synced;
+  bool inRound;
+  uint8_t winner; // Source applied in this round
+  uint32_t roundStartMs;
+  int64_t lastSyncUs; // Reference time of the last correction
+  uint32_t rounds;
+  uint32_t timeouts;
+  uint32_t wins[TIME_SRC_COUNT];
+  uint32_t lastTtfv;
+  uint32_t bestTtfv;
+  uint32_t worstTtfv;
+  uint32_t rejected;
+  uint32_t steps;
+  uint32_t slews;
+  int64_t lastDeltaUs;
+  float driftPpm;
+  float driftAvgPpm;
+  uint32_t driftSamples;
+
+  TimeVerdict apply(const TimeReply &r, int64_t deltaUs, bool step) {
+    synced = true;
+    lastSyncUs = r.refUs;
+    if (!step && llabs(deltaUs) < REDUNDANT_US)
+      return TIME_REDUNDANT;
+    lastDeltaUs = deltaUs;
+    if (step) {
+      steps++;
+      return TIME_STEP;
+    }
+    slews++;
+    return TIME_SLEW;
+  }
+
+  // Offset accumulated since the previous sync, as parts per million
+  void noteDrift(const TimeReply &r, int64_t deltaUs) {
+    if (!synced)
+      return;
+    int64_t span = r.localUs - lastSyncUs;
+    if (span < MIN_DRIFT_SPAN_US)
+      return;
+    driftPpm = (float)((double)deltaUs * 1e6 / (double)span);
+    driftSamples++;
+    driftAvgPpm = driftSamples == 1
+                      ? driftPpm
+                      : driftAvgPpm + (driftPpm - driftAvgPpm) / 4;
+  }
+};
+
+#endif
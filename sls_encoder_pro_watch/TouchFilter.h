@@ -0,0 +1,125 @@
+#ifndef TOUCH_FILTER_H
+#define TOUCH_FILTER_H
+
+#include <math.h>
+#include <stdint.h>
+
+// Touch coordinate filter that sits between the CHSC5816 driver and LVGL.
+// Per-axis 1-euro filter: heavy smoothing while the finger is nearly still
+// (kills tap/slider jitter), cutoff rises with speed so drags don't lag.
+// A short-horizon prediction from the filtered velocity hides the remaining
+// latency. Pure math, so it runs unchanged on a host build.
+
+struct TouchFilterConfig {
+  bool enabled = true;
+  float minCutoff = 1.5f;  // Hz, smoothing at rest
+  float beta = 0.02f;      // Cutoff increase per px/s of speed
+  float dCutoff = 1.0f;    // Hz, smoothing of the velocity estimate
+  uint16_t predictMs = 16; // Extrapolation horizon, 0 disables prediction
+  int16_t maxX = 389;
+  int16_t maxY = 389;
+};
+
+class OneEuroAxis {
+public:
+  OneEuroAxis() : primed(false), x(0), dx(0) {}
+
+  void reset() { primed = false; }
+
+  // dt in seconds. Returns the filtered position.
+  float filter(float raw, float dt, const TouchFilterConfig &cfg) {
+    if (!primed) {
+      primed = true;
+      x = raw;
+      dx = 0;
+      return x;
+    }
+    if (dt <= 0.0f)
+      return x; // Re-read in the same ms: keep the estimate and velocity
+    float rawDx = (raw - x) / dt;
+    dx += alpha(cfg.dCutoff, dt) * (rawDx - dx);
+    float cutoff = cfg.minCutoff + cfg.beta * fabsf(dx);
+    x += alpha(cutoff, dt) * (raw - x);
+    return x;
+  }
+
+  float velocity() const { return dx; } // px/s
+
+private:
+  bool primed;
+  float x;
+  float dx;
+
+  static float alpha(float cutoff, float dt) {
+    float tau = 1.0f / (2.0f * (float)M_PI * cutoff);
+    return 1.0f / (1.0f + tau / dt);
+  }
+};
+
+class TouchFilter {
+public:
+  explicit TouchFilter(const TouchFilterConfig &c = TouchFilterConfig())
+      : cfg(c), lastTime(0), active(false), errSum(0), speedSum(0) {}
+
+  // Filter one pressed sample in place. Call release() on touch-up so the
+  // next contact starts fresh instead of gliding from the old point.
+  void apply(uint32_t now, int16_t &x, int16_t &y) {
+    if (!cfg.enabled)
+      return;
+
+    bool fresh = !active || now != lastTime;
+    float dt = active ? (now - lastTime) / 1000.0f : 0.0f;
+    lastTime = now;
+    active = true;
+
+    float fx = ax.filter(x, dt, cfg);
+    float fy = ay.filter(y, dt, cfg);
+    if (cfg.predictMs) {
+      float h = cfg.predictMs / 1000.0f;
+      fx += ax.velocity() * h;
+      fy += ay.velocity() * h;
+    }
+
+    // Lag estimate: how far the output sits behind the finger along the
+    // direction of motion, divided by speed. Sideways noise in the raw
+    // sample cancels out instead of counting as lag; prediction that
+    // overshoots shows as negative. Only meaningful while dragging.
+    float vx = ax.velocity(), vy = ay.velocity();
+    float speed = hypotf(vx, vy);
+    if (fresh && speed > 50.0f) {
+      errSum += ((x - fx) * vx + (y - fy) * vy) / speed;
+      speedSum += speed;
+    }
+
+    x = clamp((int16_t)lroundf(fx), cfg.maxX);
+    y = clamp((int16_t)lroundf(fy), cfg.maxY);
+  }
+
+  void release() {
+    active = false;
+    ax.reset();
+    ay.reset();
+  }
+
+  // Mean drag lag in ms along the motion since the last resetStats();
+  // negative when the output leads the finger.
+  float lagMs() const {
+    return speedSum > 0 ? errSum / speedSum * 1000.0f : 0.0f;
+  }
+  void resetStats() { errSum = speedSum = 0; }
+
+  TouchFilterConfig cfg;
+
+private:
+  OneEuroAxis ax, ay;
+  uint32_t lastTime;
+  bool active;
+  float errSum;
+  float speedSum;
+
+  static int16_t clamp(int16_t v, int16_t max) {
+    return v < 0 ? 0 : (v > max ? max : v);
+  }
+};
+
+#endif
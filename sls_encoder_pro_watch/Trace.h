@@ -0,0 +1,195 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Firmware activity tracer.
+// Begin/end and counter events go into a binary ring held in a
+// caller-supplied buffer (PSRAM on device). Writers on either core claim a
+// slot with one atomic increment; when the ring is full the oldest events
+// are overwritten, so the dump always holds the most recent window.
+// dump() prints a name table and the records as hex; tools/trace2json.py
+// turns that into Chrome trace JSON (chrome://tracing, ui.perfetto.dev)
+// with one track per core. The dump is ~200 KB of text, so on device
+// beginDump() only freezes the ring and the log task prints it a few lines
+// at a time with dumpSome().
+//
+//   record (12 bytes, little endian)
+//     ts_us:u32 | point:u8 | phase:u8 ('B' 'E' 'C') | core:u8 | pad:u8 |
+//     value:i32 (counters)
+//
+// Build with -DTRACE_ENABLED=0 to compile every marker out.
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+enum TracePoint {
+  TR_LVGL,
+  TR_FLUSH,
+  TR_INDEV,
+  TR_PET,
+  TR_READER,
+  TR_TIME_UI,
+  TR_NET_UI,
+  TR_NET_TASK,
+  TR_WEATHER,
+  TR_TIME_SYNC,
+  TR_UI_BUS_DEPTH, // Counter
+  TR_FREE_HEAP,    // Counter
+  TR_POINT_COUNT
+};
+
+struct TraceRecord {
+  uint32_t ts;
+  uint8_t point;
+  uint8_t phase;
+  uint8_t core;
+  uint8_t pad;
+  int32_t value;
+};
+
+typedef uint32_t (*TraceClock)();
+typedef uint8_t (*TraceCore)();
+
+class Tracer {
+public:
+  Tracer(TraceClock clock, TraceCore core)
+      : clock(clock), core(core), ring(nullptr), capacity(0), head(0),
+        running(false), dumping(false), dumpTotal(0), dumpLine(0) {}
+
+  // capacity must be a power of two
+  void attach(TraceRecord *buf, uint32_t n) {
+    running = false;
+    ring = buf;
+    capacity = n;
+    head = 0;
+  }
+
+  bool start() {
+    if (!ring || dumping)
+      return false;
+    head = 0;
+    running = true;
+    return true;
+  }
+
+  void stop() { running = false; }
+  bool isRunning() const { return running; }
+
+  void begin(TracePoint p) { write(p, 'B', 0); }
+  void end(TracePoint p) { write(p, 'E', 0); }
+  void counter(TracePoint p, int32_t value) { write(p, 'C', value); }
+
+  // Stops tracing and freezes the ring for dumpSome().
+  void beginDump() {
+    running = false;
+    dumpTotal = head;
+    dumpLine = 0;
+    dumping = true;
+  }
+  bool isDumping() const { return dumping; }
+
+  // Prints up to maxLines more of the dump, oldest record first. False
+  // once END has been printed.
+  template <typename Printer> bool dumpSome(Printer &out, uint32_t maxLines) {
+    static const char *const NAMES[TR_POINT_COUNT] = {
+        "lv_timer_handler", "lv_disp_flush",  "lv_indev_read",
+        "PetEngine::update", "ReaderEngine::update", "update_time_ui",
+        "updateNetworkUI",  "networkTask",    "updateWeather_Internal",
+        "time_sync_round", "ui_bus_depth",   "free_heap"};
+    static const uint8_t PER_LINE = 3; // Records per hex line
+    if (!dumping)
+      return false;
+    uint32_t n = dumpTotal < capacity ? dumpTotal : capacity;
+    uint32_t first = dumpTotal - n;
+    uint32_t dataLines = (n + PER_LINE - 1) / PER_LINE;
+    char line[80];
+    for (; maxLines; maxLines--, dumpLine++) {
+      if (dumpLine == 0) {
+        snprintf(line, sizeof(line), "TRACE %lu %lu", (unsigned long)n,
+                 (unsigned long)first);
+      } else if (dumpLine <= TR_POINT_COUNT) {
+        snprintf(line, sizeof(line), "N %u %s", (unsigned)(dumpLine - 1),
+                 NAMES[dumpLine - 1]);
+      } else if (dumpLine <= TR_POINT_COUNT + dataLines) {
+        uint32_t rec = (dumpLine - 1 - TR_POINT_COUNT) * PER_LINE;
+        char *p = line;
+        for (uint32_t i = rec; i < rec + PER_LINE && i < n; i++) {
+          const uint8_t *r =
+              (const uint8_t *)&ring[(first + i) & (capacity - 1)];
+          for (uint8_t b = 0; b < sizeof(TraceRecord); b++)
+            p += snprintf(p, 3, "%02x", r[b]);
+        }
+      } else {
+        out.println("END");
+        dumping = false;
+        return false;
+      }
+      out.println(line);
+    }
+    return true;
+  }
+
+  // The whole dump in one go (host tools; blocks for all of it)
+  template <typename Printer> void dump(Printer &out) {
+    beginDump();
+    while (dumpSome(out, 0xFFFFFFFF)) {
+    }
+  }
+
+private:
+  TraceClock clock;
+  TraceCore core;
+  TraceRecord *ring;
+  uint32_t capacity;
+  std::atomic<uint32_t> head;
+  volatile bool running;
+  volatile bool dumping; // Set by beginDump(), cleared by dumpSome()
+  uint32_t dumpTotal;
+  uint32_t dumpLine;
+
+  void write(TracePoint p, uint8_t phase, int32_t value) {
+    if (!running)
+      return;
+    uint32_t i = head.fetch_add(1, std::memory_order_relaxed);
+    TraceRecord &r = ring[i & (capacity - 1)];
+    r.ts = clock();
+    r.point = p;
+    r.phase = phase;
+    r.core = core();
+    r.pad = 0;
+    r.value = value;
+  }
+};
+
+class TraceScope {
+public:
+  TraceScope(Tracer &t, TracePoint p) : tracer(t), point(p) { t.begin(p); }
+  ~TraceScope() { tracer.end(point); }
+
+private:
+  Tracer &tracer;
+  TracePoint point;
+};
+
+extern Tracer tracer;
+
+#if TRACE_ENABLED
+#define TRACE_CAT2(a, b) a##b
+#define TRACE_CAT(a, b) TRACE_CAT2(a, b)
+#define TRACE_SCOPE(p) TraceScope TRACE_CAT(trace_scope_, __LINE__)(tracer, p)
+#define TRACE_BEGIN(p) tracer.begin(p)
+#define TRACE_END(p) tracer.end(p)
+#define TRACE_COUNTER(p, v) tracer.counter(p, v)
+#else
+#define TRACE_SCOPE(p) do {} while (0)
+#define TRACE_BEGIN(p) do {} while (0)
+#define TRACE_END(p) do {} while (0)
+#define TRACE_COUNTER(p, v) do {} while (0)
+#endif
+
+#endif
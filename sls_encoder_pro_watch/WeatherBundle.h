@@ -0,0 +1,58 @@
+#ifndef WEATHER_BUNDLE_H
+#define WEATHER_BUNDLE_H
+
+#include "WeatherParser.h"
+#include <ArduinoJson.h>
+#include <stdint.h>
+
+// Weather bundle from a self-hosted gateway (tools/weathergateway.py): the
+// current conditions and the daily forecast rows, pre-aggregated from
+// OpenWeather and sent as one MsgPack array instead of two JSON bodies.
+//
+//   [version, dt, temp_decidegC, "Clouds", [[wday, hi, lo, icon], ...]]
+//
+// A gateway may append elements; anything that changes the meaning of the
+// existing ones bumps the version, which is rejected here.
+
+static const uint8_t WEATHER_BUNDLE_VERSION = 1;
+
+// Element positions
+static const size_t WB_VERSION = 0;
+static const size_t WB_DT = 1;   // Observation time, epoch seconds
+static const size_t WB_TEMP = 2; // 0.1 deg C
+static const size_t WB_MAIN = 3;
+static const size_t WB_DAYS = 4;
+
+template <typename Reader>
+DeserializationError parseWeatherBundle(Reader &input, WeatherData &out,
+                                        ArduinoJson::Allocator *alloc =
+                                            nullptr) {
+  JsonDocument doc = alloc ? JsonDocument(alloc) : JsonDocument();
+  DeserializationError err = deserializeMsgPack(doc, input);
+  out.valid = false;
+  out.days = 0;
+  if (err)
+    return err;
+
+  JsonArrayConst b = doc.as<JsonArrayConst>();
+  if (b[WB_VERSION] != WEATHER_BUNDLE_VERSION || !b[WB_TEMP].is<int>())
+    return DeserializationError::InvalidInput; // Unknown format, error body
+  out.temp = b[WB_TEMP].as<int>() / 10.0f;
+  const char *d = b[WB_MAIN];
+  out.desc.set(d ? d : "--");
+  for (JsonArrayConst row : b[WB_DAYS].as<JsonArrayConst>()) {
+    if (out.days == WEATHER_DAYS)
+      break;
+    ForecastDay &f = out.forecast[out.days];
+    f.wday = row[0].as<uint8_t>() % 7;
+    f.hi = row[1].as<int8_t>();
+    f.lo = row[2].as<int8_t>();
+    uint8_t icon = row[3].as<uint8_t>();
+    f.icon = icon < WX_ICON_COUNT ? icon : (uint8_t)WX_CLOUD;
+    out.days++;
+  }
+  out.valid = true;
+  return err;
+}
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef WEATHER_CACHE_H
+#define WEATHER_CACHE_H
+
+#include "WeatherParser.h"
+#include <stdint.h>
+#include <stdio.h>
+
+// Last weather result with its fetch time, persisted across reboots.
+// Age is measured on the wall clock (epoch seconds) when both the entry and
+// the current time are valid, otherwise on uptime for entries fetched since
+// boot. An entry whose age can't be told is stale (shown, but refetched).
+// The entry is a flat blob the caller writes to / reads from NVS.
+// One cache per location; the caller keys the blobs.
+
+struct WeatherCacheEntry {
+  uint8_t version;
+  WeatherData data;
+  uint32_t fetchedEpoch; // 0 if the clock was unset at fetch time
+};
+
+class WeatherCache {
+public:
+  static const uint8_t VERSION = 2; // 2: forecast rows
+  static const uint32_t EPOCH_VALID = 1600000000; // After 2020
+  static const int32_t AGE_UNKNOWN = -1;
+
+  // ttlS 0: set later with setTtl() (arrays of caches)
+  explicit WeatherCache(uint32_t ttlS = 0)
+      : ttl(ttlS), fetchedThisBoot(false), fetchedMs(0), hitCount(0),
+        missCount(0) {
+    entry.version = 0;
+    entry.data.valid = false;
+    entry.fetchedEpoch = 0;
+  }
+
+  // Blob loaded from storage. False if absent, stale format or invalid.
+  bool restore(const void *blob, size_t len) {
+    if (len != sizeof(WeatherCacheEntry))
+      return false;
+    const WeatherCacheEntry *e = (const WeatherCacheEntry *)blob;
+    if (e->version != VERSION || !e->data.valid)
+      return false;
+    entry = *e;
+    fetchedThisBoot = false;
+    return true;
+  }
+
+  // Returns the entry to persist.
+  const WeatherCacheEntry &store(const WeatherData &d, uint32_t epoch,
+                                 uint32_t nowMs) {
+    entry.version = VERSION;
+    entry.data = d;
+    entry.fetchedEpoch = epoch >= EPOCH_VALID ? epoch : 0;
+    fetchedThisBoot = true;
+    fetchedMs = nowMs;
+    return entry;
+  }
+
+  void setTtl(uint32_t ttlS) { ttl = ttlS; }
+
+  bool valid() const { return entry.data.valid; }
+  const WeatherData &data() const { return entry.data; }
+
+  // Seconds since the fetch, AGE_UNKNOWN if it can't be told.
+  int32_t age(uint32_t epoch, uint32_t nowMs) const {
+    if (!entry.data.valid)
+      return AGE_UNKNOWN;
+    if (entry.fetchedEpoch && epoch >= EPOCH_VALID &&
+        epoch >= entry.fetchedEpoch)
+      return epoch - entry.fetchedEpoch;
+    if (fetchedThisBoot)
+      return (nowMs - fetchedMs) / 1000;
+    return AGE_UNKNOWN;
+  }
+
+  bool fresh(uint32_t epoch, uint32_t nowMs) const {
+    int32_t a = age(epoch, nowMs);
+    return a != AGE_UNKNOWN && (uint32_t)a < ttl;
+  }
+
+  // A fetch decision: counts a hit (skip the fetch) or a miss.
+  bool check(uint32_t epoch, uint32_t nowMs) {
+    bool hit = fresh(epoch, nowMs);
+    if (hit)
+      hitCount++;
+    else
+      missCount++;
+    return hit;
+  }
+
+  template <typename Printer>
+  void report(Printer &out, uint32_t epoch, uint32_t nowMs,
+              const char *name = "Weather cache") const {
+    char line[128];
+    int32_t a = age(epoch, nowMs);
+    char ageText[16];
+    if (a == AGE_UNKNOWN)
+      snprintf(ageText, sizeof(ageText), "unknown");
+    else
+      snprintf(ageText, sizeof(ageText), "%lds", (long)a);
+    snprintf(line, sizeof(line),
+             "%s: %s %.1fC %s age=%s ttl=%lus hits=%lu misses=%lu", name,
+             entry.data.valid ? (fresh(epoch, nowMs) ? "fresh" : "stale")
+                              : "empty",
+             entry.data.valid ? entry.data.temp : 0.0f,
+             entry.data.valid ? entry.data.desc.c_str() : "-", ageText,
+             (unsigned long)ttl, (unsigned long)hitCount,
+             (unsigned long)missCount);
+    out.println(line);
+  }
+
+private:
+  uint32_t ttl;
+  WeatherCacheEntry entry;
+  bool fetchedThisBoot;
+  uint32_t fetchedMs;
+  uint32_t hitCount;
+  uint32_t missCount;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef WEATHER_PARSER_H
+#define WEATHER_PARSER_H
+
+#include "FixedString.h"
+#include <ArduinoJson.h>
+#include <stdint.h>
+
+// OpenWeather "current weather" parser.
+// Reads straight from the source (the HTTP stream on device, a recorded
+// payload on a host) with a filter, so only the fields the watch shows are
+// ever stored; the rest of the body is skipped as it streams past. Results
+// land in a fixed-size struct with no heap behind it.
+
+// Icons the forecast rows can show
+enum WeatherIcon { WX_SUN, WX_SUN_CLOUD, WX_CLOUD, WX_FOG, WX_ICON_COUNT };
+
+static const uint8_t WEATHER_DAYS = 6; // Rows on the second weather screen
+
+struct ForecastDay {
+  uint8_t wday; // 0 = Sunday
+  int8_t hi;    // deg C
+  int8_t lo;
+  uint8_t icon; // WeatherIcon
+};
+
+struct WeatherData {
+  float temp;    // deg C (units=metric)
+  FixedString<24> desc; // weather[0].main, e.g. "Clouds"
+  uint8_t days; // Forecast rows, 0 when the source has none
+  ForecastDay forecast[WEATHER_DAYS];
+  bool valid;
+};
+
+// Reader is anything deserializeJson() accepts: Stream&, const char*,
+// std::istream&, ... alloc (optional) backs the small filtered document,
+// e.g. a JsonArena so parsing leaves the heap alone.
+template <typename Reader>
+DeserializationError parseWeather(Reader &input, WeatherData &out,
+                                  ArduinoJson::Allocator *alloc = nullptr) {
+  static JsonDocument filter; // Built once, network task only
+  if (filter.isNull()) {
+    filter["main"]["temp"] = true;
+    filter["weather"][0]["main"] = true;
+  }
+
+  JsonDocument doc = alloc ? JsonDocument(alloc) : JsonDocument();
+  // As a variant: Filter(JsonDocument&) would shrink the filter every call
+  DeserializationError err = deserializeJson(
+      doc, input, DeserializationOption::Filter(filter.as<JsonVariantConst>()));
+  out.valid = false;
+  out.days = 0; // Not in the current-weather response
+  if (err)
+    return err;
+
+  JsonVariantConst temp = doc["main"]["temp"];
+  if (!temp.is<float>())
+    return DeserializationError::InvalidInput; // Error body (bad key, ...)
+  out.temp = temp.as<float>();
+  const char *d = doc["weather"][0]["main"];
+  out.desc.set(d ? d : "--");
+  out.valid = true;
+  return err;
+}
+
+#endif
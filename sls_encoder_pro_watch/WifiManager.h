@@ -0,0 +1,233 @@
+#ifndef WIFI_MANAGER_H
+#define WIFI_MANAGER_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// WiFi connection manager: a state machine fed with driver events and the
+// clock, returning the radio action for the caller to perform.
+// The radio is only on for scheduled syncs: connect, fetch (time, weather),
+// disconnect, radio off until the next sync. A failed connect (timeout or
+// the driver giving up) turns the radio off and retries after an
+// exponential backoff. With stayConnected the link is kept up between
+// syncs instead, and a drop goes through the same backoff.
+// Per sync, time-to-data (radio on -> sync finished) and radio-on time are
+// recorded for report().
+
+enum WifiState { WIFI_OFF, WIFI_CONNECTING, WIFI_ONLINE, WIFI_BACKOFF };
+
+enum WifiEvent { WIFI_EV_GOT_IP, WIFI_EV_DISCONNECTED };
+
+enum WifiAction {
+  WIFI_ACT_NONE,
+  WIFI_ACT_CONNECT,   // Radio on, begin association
+  WIFI_ACT_SYNC,      // Link is up: fetch, then call syncFinished()
+  WIFI_ACT_RADIO_OFF, // Disconnect and power the radio down
+};
+
+struct WifiConfig {
+  uint32_t syncIntervalMs;
+  uint32_t connectTimeoutMs;
+  uint32_t backoffMinMs;
+  uint32_t backoffMaxMs;
+  bool stayConnected;
+};
+
+class WifiManager {
+public:
+  explicit WifiManager(const WifiConfig &cfg)
+      : cfg(cfg), st(WIFI_OFF), deadline(0), nextSync(0), backoffMs(0),
+        radioOnAt(0), syncStart(0), radioOnMs(0), syncing(false), okCount(0),
+        failCount(0), lastTtd(0), sumTtd(0), maxTtd(0), lastRadioOn(0),
+        healthy(false), scheduled(false) {}
+
+  WifiState state() const { return st; }
+  // Last sync succeeded and the link has not failed since
+  bool isHealthy() const { return healthy; }
+
+  // Data restored at boot is current: healthy until a sync says otherwise
+  void assumeHealthy() { healthy = true; }
+
+  // Sync at `at` (now: as soon as possible). Keeps a pending backoff.
+  void requestSync(uint32_t at) {
+    nextSync = at;
+    scheduled = true;
+  }
+
+  WifiAction onEvent(uint32_t now, WifiEvent ev) {
+    switch (st) {
+    case WIFI_CONNECTING:
+      if (ev == WIFI_EV_GOT_IP) {
+        st = WIFI_ONLINE;
+        syncing = true;
+        return WIFI_ACT_SYNC;
+      }
+      return fail(now); // Driver gave up (no AP, bad password, ...)
+    case WIFI_ONLINE:
+      if (ev == WIFI_EV_DISCONNECTED)
+        return fail(now);
+      return WIFI_ACT_NONE;
+    default:
+      return WIFI_ACT_NONE; // Our own disconnect, or a stale event
+    }
+  }
+
+  // Timeouts and the sync schedule
+  WifiAction poll(uint32_t now) {
+    switch (st) {
+    case WIFI_OFF:
+      if (scheduled && due(now, nextSync))
+        return connect(now);
+      return WIFI_ACT_NONE;
+    case WIFI_CONNECTING:
+      if (due(now, deadline))
+        return fail(now);
+      return WIFI_ACT_NONE;
+    case WIFI_BACKOFF:
+      if (due(now, deadline))
+        return connect(now);
+      return WIFI_ACT_NONE;
+    case WIFI_ONLINE:
+      if (!syncing && scheduled && due(now, nextSync)) {
+        syncStart = now; // stayConnected: time-to-data from the request
+        syncing = true;
+        return WIFI_ACT_SYNC;
+      }
+      return WIFI_ACT_NONE;
+    }
+    return WIFI_ACT_NONE;
+  }
+
+  // ok: everything the sync wanted was fetched
+  WifiAction syncFinished(uint32_t now, bool ok) {
+    if (st != WIFI_ONLINE || !syncing)
+      return WIFI_ACT_NONE;
+    syncing = false;
+    if (!ok) {
+      healthy = false;
+      return fail(now);
+    }
+    uint32_t ttd = now - syncStart;
+    okCount++;
+    lastTtd = ttd;
+    sumTtd += ttd;
+    if (ttd > maxTtd)
+      maxTtd = ttd;
+    backoffMs = 0;
+    healthy = true;
+    nextSync = now + cfg.syncIntervalMs;
+    scheduled = true;
+    if (cfg.stayConnected)
+      return WIFI_ACT_NONE;
+    radioOff(now);
+    st = WIFI_OFF;
+    return WIFI_ACT_RADIO_OFF;
+  }
+
+  // How long the caller may sleep before poll() has something to do
+  uint32_t msUntilNext(uint32_t now) const {
+    switch (st) {
+    case WIFI_OFF:
+      return scheduled ? remaining(now, nextSync) : UINT32_MAX;
+    case WIFI_CONNECTING:
+    case WIFI_BACKOFF:
+      return remaining(now, deadline);
+    case WIFI_ONLINE:
+      return (!syncing && scheduled) ? remaining(now, nextSync) : UINT32_MAX;
+    }
+    return UINT32_MAX;
+  }
+
+  // Total radio-on time, including the current window
+  uint32_t radioOnTotal(uint32_t now) const {
+    return radioOnMs + (radioIsOn() ? now - radioOnAt : 0);
+  }
+
+  template <typename Printer> void report(Printer &out, uint32_t now) const {
+    static const char *names[] = {"off", "connecting", "online", "backoff"};
+    char line[112];
+    uint32_t next = msUntilNext(now);
+    if (next == UINT32_MAX)
+      snprintf(line, sizeof(line), "WiFi: %s%s", names[st],
+               healthy ? "" : " (unhealthy)");
+    else
+      snprintf(line, sizeof(line), "WiFi: %s%s, next step in %lus", names[st],
+               healthy ? "" : " (unhealthy)", (unsigned long)(next / 1000));
+    out.println(line);
+    uint32_t on = radioOnTotal(now);
+    snprintf(line, sizeof(line),
+             "  radio on %lus of %lus uptime (%.1f%%), last window %lums",
+             (unsigned long)(on / 1000), (unsigned long)(now / 1000),
+             now ? 100.0f * on / now : 0.0f, (unsigned long)lastRadioOn);
+    out.println(line);
+    snprintf(line, sizeof(line),
+             "  syncs ok=%lu failed=%lu  time-to-data last=%lums avg=%lums "
+             "max=%lums",
+             (unsigned long)okCount, (unsigned long)failCount,
+             (unsigned long)lastTtd,
+             (unsigned long)(okCount ? sumTtd / okCount : 0),
+             (unsigned long)maxTtd);
+    out.println(line);
+    if (st == WIFI_BACKOFF || backoffMs) {
+      snprintf(line, sizeof(line), "  backoff %lums", (unsigned long)backoffMs);
+      out.println(line);
+    }
+  }
+
+private:
+  WifiConfig cfg;
+  WifiState st;
+  uint32_t deadline; // Connect timeout or end of backoff
+  uint32_t nextSync;
+  uint32_t backoffMs; // Current backoff step, 0 after a success
+  uint32_t radioOnAt;
+  uint32_t syncStart;
+  uint32_t radioOnMs; // Completed radio-on windows
+  bool syncing;
+  uint32_t okCount;
+  uint32_t failCount;
+  uint32_t lastTtd;
+  uint32_t sumTtd;
+  uint32_t maxTtd;
+  uint32_t lastRadioOn;
+  bool healthy;
+  bool scheduled;
+
+  static bool due(uint32_t now, uint32_t at) {
+    return (int32_t)(now - at) >= 0;
+  }
+  static uint32_t remaining(uint32_t now, uint32_t at) {
+    return due(now, at) ? 0 : at - now;
+  }
+
+  bool radioIsOn() const {
+    return st == WIFI_CONNECTING || st == WIFI_ONLINE;
+  }
+
+  WifiAction connect(uint32_t now) {
+    st = WIFI_CONNECTING;
+    radioOnAt = syncStart = now;
+    deadline = now + cfg.connectTimeoutMs;
+    return WIFI_ACT_CONNECT;
+  }
+
+  void radioOff(uint32_t now) {
+    lastRadioOn = now - radioOnAt;
+    radioOnMs += lastRadioOn;
+  }
+
+  WifiAction fail(uint32_t now) {
+    failCount++;
+    healthy = false;
+    syncing = false;
+    radioOff(now);
+    backoffMs = backoffMs ? backoffMs * 2 : cfg.backoffMinMs;
+    if (backoffMs > cfg.backoffMaxMs)
+      backoffMs = cfg.backoffMaxMs;
+    deadline = now + backoffMs;
+    st = WIFI_BACKOFF;
+    return WIFI_ACT_RADIO_OFF;
+  }
+};
+
+#endif
@@ -37,10 +37,10 @@
 #define LV_MEM_CUSTOM 1
 #if LV_MEM_CUSTOM
 #define LV_MEM_CUSTOM_INCLUDE                                                  \
-  <stdlib.h> /*Header for the dynamic memory function*/
-#define LV_MEM_CUSTOM_ALLOC malloc
-#define LV_MEM_CUSTOM_FREE free
-#define LV_MEM_CUSTOM_REALLOC realloc
+  "lv_heap_hooks.h" /*Tagged malloc, booked to the heap accounting*/
+#define LV_MEM_CUSTOM_ALLOC lv_heap_alloc
+#define LV_MEM_CUSTOM_FREE lv_heap_free
+#define LV_MEM_CUSTOM_REALLOC lv_heap_realloc
 #endif
 
 /*=========================
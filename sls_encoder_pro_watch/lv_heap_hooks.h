@@ -0,0 +1,21 @@
+#ifndef LV_HEAP_HOOKS_H
+#define LV_HEAP_HOOKS_H
+
+/* LVGL memory hooks (see lv_conf.h). Implemented in the sketch so LVGL
+ * allocations are booked to the heap accounting (HeapAccount.h). */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void *lv_heap_alloc(size_t size);
+void lv_heap_free(void *p);
+void *lv_heap_realloc(void *p, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
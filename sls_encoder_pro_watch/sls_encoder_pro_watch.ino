@@ -61,20 +61,180 @@ Refactor to make compatible with LVGL 9.1 (proving problematic at last attempt)
 #include <ArduinoJson.h>
 #include <HTTPClient.h>
 #include <WiFi.h>
-
-const char *weather_url =
-    "http://api.openweathermap.org/data/2.5/"
-    "weather?lat=12.97&lon=77.59&units=metric&appid=" OPEN_WEATHER_API_KEY;
-
+#include <esp_freertos_hooks.h>
+
+#ifndef WEATHER_URL // Any OpenWeather-style endpoint (tools/weatherserver.py)
+#define WEATHER_URL                                                            \
+  "http://api.openweathermap.org/data/2.5/weather?units=metric&appid="         \
+  OPEN_WEATHER_API_KEY // &lat=..&lon=.. appended per location
+#endif
+// Optional: one MsgPack bundle per location, with the forecast, from a
+// self-hosted gateway (tools/weathergateway.py) instead of OpenWeather's
+// JSON; all locations in one request. e.g.
+// -DWEATHER_GATEWAY_URL='"http://192.168.1.10:8082/bundle"'
+#ifdef WEATHER_GATEWAY_URL
+const char *weather_format = "bundle";
+#else
+const char *weather_format = "json";
+#endif
+
+// Locations the weather screens page through (tap the city name). The
+// first one is home, shown on the watch faces.
+#ifndef WEATHER_LOCATIONS // {name, lat, lon}, ...
+#define WEATHER_LOCATIONS                                                      \
+  {"Bengaluru", "12.97", "77.59"}, {"Mumbai", "19.08", "72.88"},               \
+      {"Delhi", "28.61", "77.21"}
+#endif
+struct WeatherLocation {
+  const char *name;
+  const char *lat;
+  const char *lon;
+};
+const WeatherLocation weather_locations[] = {WEATHER_LOCATIONS};
+static const uint8_t WEATHER_LOCATION_COUNT =
+    sizeof(weather_locations) / sizeof(weather_locations[0]);
+static_assert(WEATHER_LOCATION_COUNT <= 32, "stale locations are a bit mask");
+
+#include "BuzzerEngine.h"
+#include "ButtonEngine.h"
+#include "EventBus.h"
+#include "EventQueue.h"
+#include "FrameStats.h"
+#include "GestureEngine.h"
+#include "GzipReader.h"
+#include "HeapAccount.h"
+#include "JsonArena.h"
+#include "LatencyProbe.h"
+#include "Logger.h"
 #include "PetEngine.h"
 #include "ReaderEngine.h"
+#include "Scheduler.h"
+#include "SessionLog.h"
+#include "Snapshot.h"
+#include "Sounds.h"
+#include "StallMonitor.h"
+#include "TaskMonitor.h"
+#include "TimeKeeper.h"
+#include "TimeService.h"
+#include "TouchFilter.h"
+#include "Trace.h"
+#include "WeatherBundle.h"
+#include "WeatherCache.h"
+#include "WeatherParser.h"
+#include "WifiManager.h"
 #include <BleMouse.h>
+#include <Preferences.h>
+#include <SPIFFS.h>
+#include <esp_idf_version.h>
+#include <esp_sntp.h>
+#if ESP_IDF_VERSION_MAJOR >= 5
+#include <esp_memory_utils.h>
+#else
+#include <soc/soc_memory_layout.h>
+#endif
 
 // --- Global App Engines ---
 PetEngine pet;
 ReaderEngine reader;
+GestureEngine gestures;
+TouchFilter touchFilter;
+ButtonEngine knobButton;
+LatencyProbe latency;
+FrameStats frames;
+SessionLog session;
+Logger logger([]() -> uint32_t { return millis(); });
+StallMonitor stalls([]() -> uint32_t { return micros(); });
+Tracer tracer([]() -> uint32_t { return micros(); },
+              []() -> uint8_t { return xPortGetCoreID(); });
+Scheduler sched;
+TaskHandle_t ui_task = NULL; // Loop task, woken by input ISRs
+TaskHandle_t net_task = NULL;
+TaskHandle_t log_task = NULL;
+int8_t clock_job = -1;
+int8_t reader_job = -1; // Only scheduled while the reader has work
 BleMouse bleMouse("DeskPet Knob", "Antigravity", 100);
 
+// --- Heap accounting (LVGL goes through lv_heap_hooks.h) ---
+static void *heap_backend_alloc(size_t size, uint32_t caps) {
+  return caps ? heap_caps_malloc(size, caps) : malloc(size);
+}
+
+static bool heap_backend_is_psram(const void *p) {
+  return esp_ptr_external_ram(p);
+}
+
+HeapAccount heap_account({heap_backend_alloc, realloc, free,
+                          heap_backend_is_psram});
+HeapTag lv_heap_tag = HEAP_LVGL; // Switched by HeapTagScope (UI task only)
+
+extern "C" void *lv_heap_alloc(size_t size) {
+  return heap_account.alloc(lv_heap_tag, size);
+}
+
+extern "C" void lv_heap_free(void *p) { heap_account.free(p); }
+
+extern "C" void *lv_heap_realloc(void *p, size_t size) {
+  return heap_account.realloc(p, size, lv_heap_tag);
+}
+
+// --- Network task buffers, reused for every request (no heap churn) ---
+#define NET_JSON_ARENA_BYTES 4096 // Filtered documents peak around 2 KB
+JsonArena<NET_JSON_ARENA_BYTES> net_json_alloc; // ArduinoJson documents
+WiFiClient net_tcp;
+HTTPClient net_http; // Always begin(net_tcp, url): no transport allocation
+
+// --- Compressed responses: gzip inflated on the way into the parser ---
+#ifndef NET_GZIP
+#define NET_GZIP true // Send Accept-Encoding: gzip
+#endif
+uint8_t *net_gzip_window = NULL; // Inflate history, PSRAM, allocated once
+tinfl_decompressor *net_gzip_state = NULL;
+uint32_t net_bodies = 0;      // Responses parsed since boot
+uint32_t net_gzip_bodies = 0; // ... of which compressed
+uint32_t net_wire_bytes = 0;  // Body bytes received
+uint32_t net_body_bytes = 0;  // Body bytes parsed (after inflating)
+
+// Before GET
+void net_accept_gzip(HTTPClient &http) {
+  static const char *keys[] = {"Content-Encoding"};
+  http.collectHeaders(keys, 1);
+  if (!NET_GZIP)
+    return;
+  if (!net_gzip_window)
+    net_gzip_window = (uint8_t *)heap_account.alloc(
+        HEAP_NET, GzipReader<WiFiClient>::WINDOW, MALLOC_CAP_SPIRAM);
+  if (!net_gzip_state)
+    net_gzip_state = (tinfl_decompressor *)heap_account.alloc(
+        HEAP_NET, sizeof(tinfl_decompressor), MALLOC_CAP_SPIRAM);
+  if (net_gzip_window && net_gzip_state)
+    http.addHeader("Accept-Encoding", "gzip");
+}
+
+// After a 200, before parsing from body
+bool net_body_begin(HTTPClient &http, GzipReader<WiFiClient> &body) {
+  bool gzip = http.header("Content-Encoding") == "gzip";
+  if (gzip && !net_gzip_state)
+    return false; // Sent unasked
+  if (!body.begin(gzip)) {
+    LOGW(LOG_NET, "Bad gzip header");
+    return false;
+  }
+  return true;
+}
+
+void net_body_end(const GzipReader<WiFiClient> &body) {
+  if (body.failed())
+    LOGW(LOG_NET, "Inflate failed after %lu bytes",
+         (unsigned long)body.wireBytes());
+  net_bodies++;
+  if (body.compressed())
+    net_gzip_bodies++;
+  net_wire_bytes += body.wireBytes();
+  net_body_bytes += body.bodyBytes();
+  LOGD(LOG_NET, "Body: %lu bytes received, %lu parsed",
+       (unsigned long)body.wireBytes(), (unsigned long)body.bodyBytes());
+}
+
 // --- Global State ---
 int current_app_index = 0; // 0=Digital, 1=Analog, 2=Pet, 3=Weather1,
                            // 4=Weather2, 5=Reader, 6=Calendar
@@ -103,51 +263,131 @@ lv_obj_t *ui_reader_screen = NULL;
 
 // --- Encoder Global ---
 volatile int encoderPos = 0;
+volatile uint32_t encoder_input_us = 0; // micros() of last unhandled tick
+volatile uint32_t knob_edge_us = 0;     // micros() of a burst's first edge
+volatile uint32_t knob_press_us = 0;    // Raw edge of the settled press
+volatile uint32_t knob_release_us = 0;  // Raw edge of the settled release
 bool encoder_has_focus = false; // Task 1: Focus Flag
 lv_obj_t *wifi_ind;             // Moved Global
 
 const char *ssid = WIFI_SSID;
 const char *password = WIFI_PASSWORD;
 
-// Global Time Settings - REMOVED NTP
-bool is_time_configured = false; // Task 37: Time State Flag
+// --- Time service: SNTP and HTTP race, first valid reply wins ---
+#ifndef TIME_HTTP_URL // Any WorldTimeAPI-style endpoint (tools/timeserver.py)
+#define TIME_HTTP_URL "http://worldtimeapi.org/api/timezone/Asia/Kolkata"
+#endif
+#ifndef TIME_NTP_SERVER_1
+#define TIME_NTP_SERVER_1 "pool.ntp.org"
+#endif
+#ifndef TIME_NTP_SERVER_2
+#define TIME_NTP_SERVER_2 "time.google.com"
+#endif
+#define TIME_STEP_MS 1000     // Further off than this: step, don't slew
+#define TIME_MAX_SLEW_MS 2000 // Later replies may not disagree by more
+#define TIME_ROUND_MS 5000    // Wait for the first valid reply
+
+TimeService time_service(TIME_STEP_MS, TIME_MAX_SLEW_MS);
+SemaphoreHandle_t time_lock; // time_service: network task vs lwIP (SNTP)
+
+static int64_t wall_us() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+// Offer a reply (refUs was current at esp_timer time refAtUs) and carry out
+// the verdict. Runs on the network task (HTTP) and the lwIP task (SNTP).
+static TimeVerdict time_offer(uint8_t source, int64_t refUs,
+                              int64_t refAtUs) {
+  xSemaphoreTake(time_lock, portMAX_DELAY);
+  int64_t at = esp_timer_get_time();
+  TimeReply r = {source, refUs + (at - refAtUs), wall_us(),
+                 (uint32_t)(refAtUs / 1000)};
+  int64_t delta;
+  TimeVerdict v = time_service.offer(r, delta);
+  if (v == TIME_STEP) {
+    int64_t t = wall_us() + delta;
+    struct timeval tv = {(time_t)(t / 1000000), (suseconds_t)(t % 1000000)};
+    settimeofday(&tv, NULL);
+  } else if (v == TIME_SLEW) {
+    struct timeval tv = {(time_t)(delta / 1000000),
+                         (suseconds_t)(delta % 1000000)};
+    adjtime(&tv, NULL);
+  }
+  xSemaphoreGive(time_lock);
+  if (v == TIME_STEP || v == TIME_SLEW)
+    LOGI(LOG_NET, "Time %s by %lldms (%s)",
+         v == TIME_STEP ? "stepped" : "slewed", (long long)(delta / 1000),
+         source == TIME_SRC_NTP ? "ntp" : "http");
+  return v;
+}
+
+// Replaces ESP-IDF's weak default: SNTP replies go through time_service
+// instead of being applied unconditionally (lwIP task)
+extern "C" void sntp_sync_time(struct timeval *tv) {
+  time_offer(TIME_SRC_NTP, (int64_t)tv->tv_sec * 1000000 + tv->tv_usec,
+             esp_timer_get_time());
+  sntp_set_sync_status(SNTP_SYNC_STATUS_COMPLETED);
+  if (net_task)
+    xTaskNotifyGive(net_task);
+}
 
 // Task 41: HTTP Time Sync Function
 // Task 61: HTTP Time Sync Function (Re-implemented)
-void syncTimeViaHTTP() {
-  Serial.println("NetTask: Fetching time from WorldTimeAPI...");
-  HTTPClient http;
-  // Use a reliable JSON time API
-  http.begin("http://worldtimeapi.org/api/timezone/Asia/Kolkata");
+// One contestant of the race: unixtime plus the fraction from "datetime",
+// moved forward by half the request's round trip
+bool syncTimeViaHTTP() {
+  LOGD(LOG_NET, "Fetching time from %s", TIME_HTTP_URL);
+  bool ok = false;
+  static JsonDocument filter; // Built once, network task only
+  if (filter.isNull()) {
+    filter["unixtime"] = true;
+    filter["datetime"] = true;
+  }
+  HTTPClient &http = net_http;
+  http.useHTTP10(true); // Parse the bare body off the socket
+  http.begin(net_tcp, TIME_HTTP_URL);
   http.setTimeout(3000);
+  net_accept_gzip(http);
 
+  int64_t sent = esp_timer_get_time();
   int httpCode = http.GET();
-  if (httpCode > 0) {
-    String payload = http.getString();
-    JsonDocument doc;
-    if (!deserializeJson(doc, payload)) {
-      long unixtime = doc["unixtime"];
-
-      if (unixtime > 1600000000) { // Valid Epoch (> 2020)
-        // Task 62: Inject Time
-        struct timeval tv;
-        tv.tv_sec = unixtime;
-        tv.tv_usec = 0;
-        settimeofday(&tv, NULL);
-
-        Serial.printf("NetTask: HTTP Time Sync Success! Epoch: %ld\n",
-                      unixtime);
-        is_time_configured = true;
-      } else {
-        Serial.println("NetTask: Invalid Epoch from API");
+  int64_t rx = esp_timer_get_time();
+  GzipReader<WiFiClient> body(http.getStream(), net_gzip_window,
+                              net_gzip_state, http.getSize());
+  if (httpCode == HTTP_CODE_OK && net_body_begin(http, body)) {
+    JsonDocument doc(&net_json_alloc);
+    DeserializationError error =
+        deserializeJson(doc, body,
+                        DeserializationOption::Filter(
+                            filter.as<JsonVariantConst>()));
+    net_body_end(body);
+    if (!error) {
+      int64_t unixtime = doc["unixtime"] | (int64_t)0;
+      // "2026-10-18T10:00:00.123456+05:30": up to 6 fraction digits
+      int32_t frac = 0;
+      const char *dt = doc["datetime"];
+      const char *dot = dt ? strchr(dt, '.') : NULL;
+      if (dot) {
+        int32_t scale = 100000;
+        for (const char *c = dot + 1; *c >= '0' && *c <= '9' && scale;
+             c++, scale /= 10)
+          frac += (*c - '0') * scale;
       }
+      TimeVerdict v = time_offer(
+          TIME_SRC_HTTP, unixtime * 1000000 + frac + (rx - sent) / 2, rx);
+      ok = v != TIME_REJECTED;
+      if (!ok)
+        LOGW(LOG_NET, "Invalid Epoch from API");
     } else {
-      Serial.println("NetTask: Failed to parse Time JSON");
+      LOGW(LOG_NET, "Failed to parse Time JSON");
     }
   } else {
-    Serial.printf("NetTask: HTTP Time Request Failed: %d\n", httpCode);
+    LOGW(LOG_NET, "HTTP Time Request Failed: %d", httpCode);
   }
   http.end();
+  return ok;
 }
 
 // Forward declarations
@@ -157,32 +397,126 @@ void perform_screen_switch(int index);
 // Shared UI pointer for Reader Screen
 // lv_obj_t* ui_reader_screen = NULL; // Removed duplicate
 
-void playTone(int freq, int duration) {
-  ledcWriteTone(0, freq); // Use channel 0
-  delay(duration);
-  ledcWriteTone(0, 0);
+// --- Buzzer (sequenced from an esp_timer, never blocks the caller) ---
+BuzzerSequencer buzzer;
+esp_timer_handle_t buzzer_timer;
+
+static void buzzer_timer_cb(void *) {
+  uint32_t now = millis();
+  BuzzerStep st = buzzer.step(now);
+  if (st.changed)
+    ledcWriteTone(0, st.freq); // Use channel 0
+  if (st.active) {
+    int32_t wait = (int32_t)(st.wakeMs - now);
+    esp_timer_start_once(buzzer_timer, (wait > 0 ? wait : 1) * 1000ULL);
+  }
+}
+
+void playSound(const BuzzerPattern &p) {
+  if (!buzzer.play(p))
+    return;
+  // Kick the timer so the request is looked at now; retry once if the
+  // callback re-armed it in between
+  esp_timer_stop(buzzer_timer);
+  if (esp_timer_start_once(buzzer_timer, 0) != ESP_OK) {
+    esp_timer_stop(buzzer_timer);
+    esp_timer_start_once(buzzer_timer, 0);
+  }
+}
+
+void squeak() { playSound(SND_SQUEAK); }
+void growl() { playSound(SND_GROWL); }
+void snore() { playSound(SND_SNORE); }
+
+// --- UI Event Bus (BLE link edges -> UI handlers) ---
+enum UiEventType { UI_EV_BLE };
+
+struct UiEvent {
+  uint8_t type;
+  bool connected; // UI_EV_BLE
+};
+
+EventBus<UiEvent, 32> ui_bus;
+
+// Posted by the UI loop itself and drained later in the same pass, so no
+// wake-up is needed
+void post_ui_event(UiEventType type, bool connected) {
+  UiEvent ev;
+  ev.type = type;
+  ev.connected = connected;
+  ui_bus.post(ev);
+  TRACE_COUNTER(TR_UI_BUS_DEPTH, ui_bus.depth());
+}
+
+// The BLE stack has no link callback for us: poll the flag once per loop
+// pass and post the edges
+void poll_ble_link() {
+  static bool was_connected = false;
+  bool connected = bleMouse.isConnected();
+  if (connected != was_connected) {
+    was_connected = connected;
+    post_ui_event(UI_EV_BLE, connected);
+  }
+}
+
+// --- Network state for the UI (latest value, not a stream of events) ---
+struct NetWeather {
+  bool valid;
+  int16_t temp;
+  FixedString<24> desc;
+  uint8_t days; // Forecast rows (weather gateway only)
+  ForecastDay forecast[WEATHER_DAYS];
+};
+
+struct NetState {
+  bool linkUp; // Last WiFi sync got through
+  NetWeather weather[WEATHER_LOCATION_COUNT]; // weather_locations order
+  uint32_t timeSyncs; // Bumped whenever the clock is set
+};
+
+// Same content, as far as the UI is concerned
+static bool net_weather_same(const NetWeather &a, const NetWeather &b) {
+  return a.valid == b.valid && a.temp == b.temp && a.desc == b.desc &&
+         a.days == b.days &&
+         !memcmp(a.forecast, b.forecast, a.days * sizeof(ForecastDay));
 }
 
-void squeak() {
-  playTone(2000, 50);
-  playTone(2500, 50);
+// Written by the network task (and setup() before it starts), read by the
+// UI without locks; see Snapshot.h
+Snapshot<NetState> net_state;
+
+void net_publish(const NetState &s) {
+  net_state.publish(s);
+  if (ui_task)
+    xTaskNotifyGive(ui_task);
 }
-void growl() {
-  for (int f = 200; f > 100; f -= 10)
-    playTone(f, 20);
+
+void net_publish_link(bool up) {
+  NetState s = net_state.last();
+  s.linkUp = up;
+  net_publish(s);
 }
-void snore() { playTone(300, 100); }
 
-// --- Shared Network Data (Thread Safe via Atomic/Volatile) ---
-volatile bool xWifiConnected = false;
-volatile bool xWeatherUpdated = false;
-String xWeatherDesc = "--";
-int xTemp = 0;
-SemaphoreHandle_t xNetworkMutex;
+void net_publish_weather(uint8_t loc, const WeatherData &w) {
+  NetState s = net_state.last();
+  NetWeather &nw = s.weather[loc];
+  nw.valid = true;
+  nw.temp = (int16_t)w.temp;
+  nw.desc = w.desc;
+  nw.days = w.days;
+  memcpy(nw.forecast, w.forecast, sizeof(nw.forecast));
+  net_publish(s);
+}
+
+void net_publish_time_sync() {
+  NetState s = net_state.last();
+  s.timeSyncs++;
+  net_publish(s);
+}
 
 // Task 11: WiFi Setup Function (Non-blocking)
 void setupWiFi_Internal() {
-  Serial.println("NetTask: Connecting to WiFi...");
+  LOGI(LOG_NET, "Connecting to WiFi...");
   // Task 65: Credential Check (Logs Removed)
   /*
   Serial.print("Attempting to connect to: ");
@@ -193,192 +527,665 @@ void setupWiFi_Internal() {
     Serial.println("Password is NULL!");
   }
   */
+  WiFi.mode(WIFI_STA);
   WiFi.begin(ssid, password);
 
   // Task 38: Removed configTime from here (Too Early)
 }
 
-void updateWeather_Internal() {
-  Serial.println("NetTask: Entering updateWeather_Internal");
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("NetTask: WiFi not connected, skipping weather update");
+// --- Weather cache, one per location (NVS, survives reboots) ---
+#define WEATHER_TTL_S 1800 // Refetch after 30 mins
+WeatherCache weather_cache[WEATHER_LOCATION_COUNT]; // TTL set at restore
+
+static uint32_t epoch_now() { return (uint32_t)time(NULL); }
+
+// NVS key from the coordinates, so editing the list never shows one
+// place's weather under another's name
+static void weather_cache_key(uint8_t loc, char *key, size_t len) {
+  uint32_t h = 2166136261u; // FNV-1a over "lat,lon"
+  for (const char *c = weather_locations[loc].lat; *c; c++)
+    h = (h ^ (uint8_t)*c) * 16777619u;
+  h = (h ^ ',') * 16777619u;
+  for (const char *c = weather_locations[loc].lon; *c; c++)
+    h = (h ^ (uint8_t)*c) * 16777619u;
+  snprintf(key, len, "w%08lx", (unsigned long)h);
+}
+
+static void weather_cache_save(uint8_t loc, const WeatherCacheEntry &e) {
+  Preferences prefs;
+  if (!prefs.begin("weather", false))
+    return;
+  char key[12];
+  weather_cache_key(loc, key, sizeof(key));
+  prefs.putBytes(key, &e, sizeof(e));
+  prefs.end();
+}
+
+// Before locations, one entry under "last", for the fixed 12.97,77.59: it
+// becomes home's entry if home is still there, and is deleted either way
+static void weather_cache_migrate() {
+  Preferences prefs;
+  if (!prefs.begin("weather", true))
     return;
+  bool old = prefs.isKey("last");
+  prefs.end();
+  if (!old || !prefs.begin("weather", false))
+    return;
+  char key[12];
+  weather_cache_key(0, key, sizeof(key));
+  WeatherCacheEntry e;
+  if (!strcmp(weather_locations[0].lat, "12.97") &&
+      !strcmp(weather_locations[0].lon, "77.59") && !prefs.isKey(key) &&
+      prefs.getBytes("last", &e, sizeof(e)) == sizeof(e))
+    prefs.putBytes(key, &e, sizeof(e));
+  prefs.remove("last");
+  prefs.end();
+}
+
+// Show the last known weather before the network is up
+void weather_cache_restore() {
+  weather_cache_migrate();
+  Preferences prefs;
+  bool open = prefs.begin("weather", true);
+  for (uint8_t loc = 0; loc < WEATHER_LOCATION_COUNT; loc++) {
+    weather_cache[loc].setTtl(WEATHER_TTL_S);
+    char key[12];
+    weather_cache_key(loc, key, sizeof(key));
+    WeatherCacheEntry e;
+    size_t n = open && prefs.isKey(key) ? prefs.getBytes(key, &e, sizeof(e))
+                                        : 0;
+    if (!weather_cache[loc].restore(&e, n))
+      continue;
+    net_publish_weather(loc, e.data);
+    LOGI(LOG_NET, "Weather for %s restored from cache (age %lds)",
+         weather_locations[loc].name,
+         (long)weather_cache[loc].age(epoch_now(), millis()));
   }
+  if (open)
+    prefs.end();
+}
 
-  HTTPClient http;
-  http.begin(weather_url);
-  http.setTimeout(2000); // Strict timeout for network task too
-  int httpCode = http.GET();
+// Locations due for a fetch, as a bit mask
+static uint32_t weather_stale(uint32_t epoch, uint32_t nowMs) {
+  uint32_t stale = 0;
+  for (uint8_t loc = 0; loc < WEATHER_LOCATION_COUNT; loc++)
+    if (!weather_cache[loc].fresh(epoch, nowMs))
+      stale |= 1UL << loc;
+  return stale;
+}
 
-  if (httpCode > 0) {
-    String payload = http.getString();
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, payload);
-    if (!error) {
-      float t = doc["main"]["temp"];
-      const char *d = doc["weather"][0]["main"];
-
-      // Update Shared Data safely
-      if (xSemaphoreTake(xNetworkMutex, portMAX_DELAY)) {
-        xTemp = (int)t;
-        xWeatherDesc = String(d);
-        xWeatherUpdated = true;
-        xSemaphoreGive(xNetworkMutex);
-      }
-    }
+// Seconds until the first location is due (0: one already is)
+static uint32_t weather_fresh_for(uint32_t epoch, uint32_t nowMs) {
+  uint32_t left = WEATHER_TTL_S;
+  for (uint8_t loc = 0; loc < WEATHER_LOCATION_COUNT; loc++) {
+    if (!weather_cache[loc].fresh(epoch, nowMs))
+      return 0;
+    uint32_t l = WEATHER_TTL_S - weather_cache[loc].age(epoch, nowMs);
+    if (l < left)
+      left = l;
   }
-  http.end();
-  Serial.println("NetTask: Leaving updateWeather_Internal");
+  return left;
 }
 
-// Task 11: Network Task Function (Core 0)
-void networkTask(void *parameter) {
-  Serial.println("NetTask: Started");
+// --- Time persistence: RTC memory (resets, sleep) and NVS (power loss) ---
+#define TIME_TZ "IST-5:30"      // Same offset configTime() sets later
+#define TIME_HIGH_ERR_MS 1000   // Trusted enough to skip the time sync
+#define TIME_MEDIUM_ERR_MS 30000
+#define TIME_DRIFT_FLOOR_PPM 30 // Crystal tolerance until drift is measured
+#define TIME_RTC_SAVE_S 60
+#define TIME_NVS_SAVE_S 600 // Flash wear: every 10 mins and at syncs
+#define TIME_FLOOR_SLACK_S 300 // The saved clock may have run a little fast
+
+RTC_NOINIT_ATTR TimeRecord time_rtc;
+TimeKeeper time_keeper(TIME_HIGH_ERR_MS, TIME_MEDIUM_ERR_MS,
+                       TIME_DRIFT_FLOOR_PPM);
+
+// Called from setup() before LVGL, so the first frame shows the time. A
+// time saved before power loss isn't shown: the clock stays unset until a
+// sync, which must not be earlier than it.
+void time_restore() {
+  setenv("TZ", TIME_TZ, 1);
+  tzset();
+  TimeRecord nvs = {};
+  Preferences prefs;
+  if (prefs.begin("time", true)) {
+    if (prefs.isKey("rec"))
+      prefs.getBytes("rec", &nvs, sizeof(nvs));
+    prefs.end();
+  }
+  time_keeper.restore(time_rtc, nvs, epoch_now());
+  uint32_t floor = time_keeper.floor();
+  if (floor)
+    time_service.setFloor(floor - TIME_FLOOR_SLACK_S);
+  TimeConfidence c = time_keeper.confidence(epoch_now());
+  if (time_keeper.restoredFrom() == TIME_FROM_CLOCK)
+    LOGI(LOG_SYS, "Clock kept running, confidence %d", c);
+  else if (floor)
+    LOGI(LOG_SYS, "Clock unset until a sync, not before %lu",
+         (unsigned long)floor);
+  else
+    LOGI(LOG_SYS, "Clock unset");
+}
 
-  // Task 66: WiFi Event Handler (Logs Removed)
-  /*
-  WiFi.onEvent([](WiFiEvent_t event, WiFiEventInfo_t info) {
-    Serial.printf("WiFi Event: %d\n", event);
-    if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
-      Serial.printf("Reason: %d\n", info.wifi_sta_disconnected.reason);
+// Network task: RTC copy every minute, NVS less often (or now, after a sync)
+void time_persist(bool now) {
+  static uint32_t rtc_at = 0, nvs_at = 0;
+  uint32_t e = epoch_now();
+  if (e < TimeKeeper::EPOCH_VALID)
+    return;
+  if (now || e - rtc_at >= TIME_RTC_SAVE_S) {
+    time_rtc = time_keeper.record(e);
+    rtc_at = e;
+  }
+  if (now || e - nvs_at >= TIME_NVS_SAVE_S) {
+    Preferences prefs;
+    if (prefs.begin("time", false)) {
+      prefs.putBytes("rec", &time_rtc, sizeof(time_rtc));
+      prefs.end();
     }
-  });
-  */
+    nvs_at = e;
+  }
+}
 
-  setupWiFi_Internal();
+// Last sync's fetch, to compare the bundle against direct JSON ('w')
+uint32_t weather_read_us = 0; // Receiving and parsing the bodies
+uint32_t weather_body_bytes = 0;
+uint8_t weather_fetched = 0;  // Locations updated
+uint8_t weather_requests = 0;
+uint8_t weather_connects = 0; // TCP connections opened
+
+static void weather_accept(uint8_t loc, const WeatherData &w) {
+  weather_cache_save(loc, weather_cache[loc].store(w, epoch_now(), millis()));
+  net_publish_weather(loc, w);
+  weather_fetched++;
+}
 
-  // Initial Weather Fetch
-  updateWeather_Internal();
+// GET on net_http, which the caller has begun
+static int weather_get() {
+  HTTPClient &http = net_http;
+  http.setTimeout(2000); // Strict timeout for network task too
+  net_accept_gzip(http);
+  if (!net_tcp.connected())
+    weather_connects++;
+  weather_requests++;
+  int httpCode = http.GET();
+  if (httpCode != HTTP_CODE_OK)
+    LOGW(LOG_NET, "Weather request failed: %d", httpCode);
+  return httpCode;
+}
 
-  for (;;) {
-    // Monitor Connection
-    bool connected = (WiFi.status() == WL_CONNECTED);
-    if (xSemaphoreTake(xNetworkMutex, portMAX_DELAY)) {
-      xWifiConnected = connected;
-      xSemaphoreGive(xNetworkMutex);
+#ifdef WEATHER_GATEWAY_URL
+// "?loc=lat,lon;lat,lon..." for as many stale locations as fit in `url`.
+// Returns the ones it holds; the rest go in another request.
+static uint32_t weather_gateway_url(char *url, size_t size, uint32_t stale) {
+  size_t n = snprintf(url, size, "%s?loc=", WEATHER_GATEWAY_URL);
+  uint32_t asked = 0;
+  for (uint8_t loc = 0; loc < WEATHER_LOCATION_COUNT && n < size; loc++) {
+    if (!(stale & (1UL << loc)))
+      continue;
+    size_t k = snprintf(url + n, size - n, "%s%s,%s", asked ? ";" : "",
+                        weather_locations[loc].lat, weather_locations[loc].lon);
+    if (n + k >= size) {
+      url[n] = 0; // Cut mid-location: leave it out
+      break;
     }
+    n += k;
+    asked |= 1UL << loc;
+  }
+  return asked;
+}
 
-    // Reconnect if needed
-    if (!connected) {
-      WiFi.reconnect();
-      is_time_configured = false; // Reset on Disconnect
-      vTaskDelay(5000 / portTICK_PERIOD_MS);
-    }
-    // Task 69: Restore Standard NTP
-    else if (connected && !is_time_configured) {
-      Serial.println("NetTask: WiFi Connected! Starting Standard NTP...");
-      // Task 71: Kickstart Weather
-      updateWeather_Internal();
-
-      // IST = UTC + 5:30 (19800 seconds)
-      configTime(19800, 0, "pool.ntp.org", "time.google.com");
-      is_time_configured = true;
+// The asked locations in one request; the gateway sends their bundles back
+// to back, in the order asked
+static void weather_fetch_bundles(const char *url, uint32_t asked) {
+  HTTPClient &http = net_http;
+  http.useHTTP10(true); // No chunked encoding: the stream is the bare body
+  http.begin(net_tcp, url);
+  int httpCode = weather_get();
+  GzipReader<WiFiClient> body(http.getStream(), net_gzip_window,
+                              net_gzip_state, http.getSize());
+  if (httpCode == HTTP_CODE_OK && net_body_begin(http, body)) {
+    uint32_t t0 = micros();
+    for (uint8_t loc = 0; loc < WEATHER_LOCATION_COUNT; loc++) {
+      if (!(asked & (1UL << loc)))
+        continue;
+      WeatherData w;
+      DeserializationError error =
+          parseWeatherBundle(body, w, &net_json_alloc);
+      if (w.valid)
+        weather_accept(loc, w);
+      else if (error != DeserializationError::InvalidInput)
+        break; // Cut short: the rest can't be framed
+      else
+        LOGW(LOG_NET, "No bundle for %s", weather_locations[loc].name);
     }
+    weather_read_us += micros() - t0;
+    weather_body_bytes += body.wireBytes();
+    net_body_end(body);
+  }
+  http.end();
+}
 
-    // Update Weather periodically (every 30 mins)
-    static int ticks = 0;
-    ticks++;
-    if (ticks >= 1800) { // 1800 * 1s = 30 mins
-      updateWeather_Internal();
-      ticks = 0;
+// All stale locations, in as few requests as the URL buffer allows
+static void weather_fetch(uint32_t stale) {
+  static char url[192 + WEATHER_LOCATION_COUNT * 24];
+  while (stale) {
+    uint32_t asked = weather_gateway_url(url, sizeof(url), stale);
+    if (!asked) {
+      LOGE(LOG_NET, "Weather gateway URL too long for %u bytes",
+           (unsigned)sizeof(url));
+      return;
     }
-
-    // Heartbeat for Debugging (Disabled)
-    /*
-    if (ticks % 5 == 0) {
-      Serial.printf("NetTask: Alive | WiFi Status: %d | Time Configured: %d\n",
-                    WiFi.status(), is_time_configured);
+    stale &= ~asked;
+    if (stale)
+      LOGW(LOG_NET, "Weather URL full, %d locations in another request",
+           __builtin_popcount(stale));
+    weather_fetch_bundles(url, asked);
+  }
+}
+#else
+// One request per location, over one keep-alive connection
+static void weather_fetch(uint32_t stale) {
+  static char url[sizeof(WEATHER_URL) + 48];
+  HTTPClient &http = net_http;
+  for (uint8_t loc = 0; loc < WEATHER_LOCATION_COUNT; loc++) {
+    if (!(stale & (1UL << loc)))
+      continue;
+    snprintf(url, sizeof(url), "%s&lat=%s&lon=%s", WEATHER_URL,
+             weather_locations[loc].lat, weather_locations[loc].lon);
+    http.useHTTP10(true); // No chunked encoding: the stream is the bare body
+    http.setReuse(true);  // Connection: keep-alive
+    http.begin(net_tcp, url);
+    int httpCode = weather_get();
+    GzipReader<WiFiClient> body(http.getStream(), net_gzip_window,
+                                net_gzip_state, http.getSize());
+    bool reusable = false;
+    if (httpCode == HTTP_CODE_OK && net_body_begin(http, body)) {
+      // Parse straight off the socket, keeping only the fields we show
+      WeatherData w;
+      uint32_t t0 = micros();
+      DeserializationError error = parseWeather(body, w, &net_json_alloc);
+      reusable = body.drain(); // Next request starts at a clean boundary
+      weather_read_us += micros() - t0;
+      weather_body_bytes += body.wireBytes();
+      net_body_end(body);
+      LOGD(LOG_NET, "Weather for %s parsed: %s", weather_locations[loc].name,
+           error.c_str());
+      if (w.valid)
+        weather_accept(loc, w);
     }
-    */
+    http.end(); // Keeps the connection if the server agreed
+    if (!reusable)
+      net_tcp.stop();
+  }
+}
+#endif
 
-    vTaskDelay(1000 / portTICK_PERIOD_MS); // 1 sec loop
+bool updateWeather_Internal(uint32_t stale) {
+  TRACE_SCOPE(TR_WEATHER);
+  LOGD(LOG_NET, "Entering updateWeather_Internal");
+  if (WiFi.status() != WL_CONNECTED) {
+    LOGD(LOG_NET, "WiFi not connected, skipping weather update");
+    return false;
   }
+  weather_read_us = weather_body_bytes = 0;
+  weather_fetched = weather_requests = weather_connects = 0;
+  weather_fetch(stale);
+  net_tcp.stop(); // Time sync talks to another host next round
+  LOGD(LOG_NET, "Weather: %u locations in %u requests, %u connections",
+       weather_fetched, weather_requests, weather_connects);
+  return weather_fetched > 0;
 }
 
-// UI Updater (runs in Loop/Core 1)
-void updateNetworkUI() {
-  // 1. Update Connection Icon
-  bool connected = false;
-  if (xSemaphoreTake(xNetworkMutex, 0)) { // Non-blocking take
-    connected = xWifiConnected;
-    xSemaphoreGive(xNetworkMutex);
+// Fetch the locations whose cached result ran out. False if some were due
+// and none came in; each one that didn't stays stale in its own cache and
+// is fetched again next sync.
+bool refreshWeather() {
+  uint32_t stale = 0;
+  for (uint8_t loc = 0; loc < WEATHER_LOCATION_COUNT; loc++)
+    if (!weather_cache[loc].check(epoch_now(), millis()))
+      stale |= 1UL << loc;
+  if (!stale) {
+    LOGI(LOG_NET, "Weather cache hit for all %u locations",
+         WEATHER_LOCATION_COUNT);
+    return true;
   }
+  bool ok = updateWeather_Internal(stale);
+  uint32_t left = weather_stale(epoch_now(), millis());
+  if (left)
+    LOGW(LOG_NET, "Weather still stale for mask 0x%lx",
+         (unsigned long)left);
+  return ok;
+}
 
-  if (wifi_ind) {
-    // Task 67: Red/Green Indicator
-    if (connected) {
-      lv_obj_set_style_bg_color(wifi_ind, lv_color_hex(0x00FF00), 0); // Green
-    } else {
-      lv_obj_set_style_bg_color(wifi_ind, lv_color_hex(0xFF0000), 0); // Red
-    }
+// Log drain (Core 0, low priority). Only this task may block on Serial.
+// A trace dump ('T') is printed from here too, a slice per pass so log
+// lines keep flowing and the log bus doesn't overflow behind it.
+#define TRACE_DUMP_LINES 32 // About 2.3 KB of hex per slice
+
+void logTask(void *parameter) {
+  for (;;) {
+    logger.drain(Serial);
+    bool dumping = tracer.dumpSome(Serial, TRACE_DUMP_LINES);
+    vTaskDelay(dumping ? 1 : 20 / portTICK_PERIOD_MS); // Next slice: 1 tick
   }
+}
 
-  // 2. Update Weather Data if available
-  bool hasUpdate = false;
-  String desc;
-  int temp;
+// --- WiFi: radio on only for scheduled syncs (WifiManager.h) ---
+#define WIFI_SYNC_INTERVAL_MS (WEATHER_TTL_S * 1000UL) // One sync per TTL
+#define WIFI_CONNECT_TIMEOUT_MS 15000
+#define WIFI_BACKOFF_MIN_MS 5000
+#define WIFI_BACKOFF_MAX_MS 600000 // 10 mins
+#define WIFI_STAY_CONNECTED false
+
+WifiManager wifi_mgr({WIFI_SYNC_INTERVAL_MS, WIFI_CONNECT_TIMEOUT_MS,
+                      WIFI_BACKOFF_MIN_MS, WIFI_BACKOFF_MAX_MS,
+                      WIFI_STAY_CONNECTED});
+EventQueue<uint8_t, 8> wifi_events; // WiFi event task -> network task
+volatile uint8_t wifi_disconnect_reason = 0;
+
+// Runs in the WiFi event task: hand over and wake the network task
+static void wifi_event_cb(WiFiEvent_t event, WiFiEventInfo_t info) {
+  uint8_t ev;
+  if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+    ev = WIFI_EV_GOT_IP;
+  } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+    ev = WIFI_EV_DISCONNECTED;
+    wifi_disconnect_reason = info.wifi_sta_disconnected.reason;
+  } else {
+    return;
+  }
+  wifi_events.push(ev);
+  if (net_task)
+    xTaskNotifyGive(net_task);
+}
+
+static void wifi_radio_off() {
+  WiFi.disconnect(true); // Also stops the driver
+  WiFi.mode(WIFI_OFF);
+}
+
+// Ask SNTP and the HTTP endpoint at once; the first valid reply sets the
+// clock (time_offer), a later, more precise one slews it.
+bool time_sync_round() {
+  TRACE_SCOPE(TR_TIME_SYNC);
+  xSemaphoreTake(time_lock, portMAX_DELAY);
+  time_service.startRound(millis());
+  xSemaphoreGive(time_lock);
+  // IST = UTC + 5:30 (19800 seconds). Restarts SNTP: a request goes out now
+  configTime(19800, 0, TIME_NTP_SERVER_1, TIME_NTP_SERVER_2);
+  syncTimeViaHTTP(); // Meanwhile SNTP may already have won
+
+  uint32_t start = millis();
+  bool won;
+  for (;;) {
+    xSemaphoreTake(time_lock, portMAX_DELAY);
+    won = time_service.roundWon();
+    bool over = won || millis() - start >= TIME_ROUND_MS;
+    if (over)
+      time_service.endRound();
+    xSemaphoreGive(time_lock);
+    if (over)
+      break;
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(50)); // Woken by sntp_sync_time
+  }
+  if (won) {
+    time_keeper.synced(epoch_now(), time_service.drift());
+    time_persist(true);
+    net_publish_time_sync();
+  } else {
+    LOGW(LOG_NET, "No valid time reply within %ums", TIME_ROUND_MS);
+  }
+  return won;
+}
+
+// One radio-on window: time (SNTP racing HTTP), then weather.
+// Succeeds when the clock is set and at least one due location came in:
+// one location failing doesn't send the whole sync into backoff.
+bool network_sync() {
+  uint32_t e = epoch_now();
+  if (time_keeper.confidence(e) == TIME_CONF_HIGH)
+    LOGI(LOG_NET, "Clock trusted (error ~%lums), no time sync",
+         (unsigned long)time_keeper.errorMs(e));
+  else
+    time_sync_round();
+  bool weather = refreshWeather();
+  return epoch_now() >= WeatherCache::EPOCH_VALID && weather;
+}
 
-  if (xSemaphoreTake(xNetworkMutex, 0)) {
-    if (xWeatherUpdated) {
-      hasUpdate = true;
-      desc = xWeatherDesc;
-      temp = xTemp;
-      xWeatherUpdated = false; // clear flag
+// Carry out what the manager asked for. A sync runs right here and its
+// outcome usually asks for the radio to go off.
+static void wifi_apply(WifiAction act) {
+  switch (act) {
+  case WIFI_ACT_NONE:
+    break;
+  case WIFI_ACT_CONNECT:
+    setupWiFi_Internal();
+    break;
+  case WIFI_ACT_SYNC:
+    wifi_apply(wifi_mgr.syncFinished(millis(), network_sync()));
+    break;
+  case WIFI_ACT_RADIO_OFF:
+    wifi_radio_off();
+    if (wifi_mgr.state() == WIFI_BACKOFF)
+      LOGW(LOG_NET, "WiFi sync failed (reason %u), retry in %lus",
+           wifi_disconnect_reason,
+           (unsigned long)(wifi_mgr.msUntilNext(millis()) / 1000));
+    else
+      LOGI(LOG_NET, "Sync done, radio off for %lus",
+           (unsigned long)(wifi_mgr.msUntilNext(millis()) / 1000));
+    wifi_disconnect_reason = 0;
+    break;
+  }
+}
+
+// Task 11: Network Task Function (Core 0)
+// Event driven: sleeps until a WiFi event or the manager's next deadline.
+void networkTask(void *parameter) {
+  LOGI(LOG_NET, "Started");
+  WiFi.persistent(false);       // Don't rewrite credentials on every connect
+  WiFi.setAutoReconnect(false); // Retries are scheduled by wifi_mgr
+  WiFi.onEvent(wifi_event_cb);
+  // No radio at boot while the kept clock is trusted and the cached weather
+  // fresh: the first sync is due when either runs out
+  uint32_t e = epoch_now();
+  uint32_t defer_s = 0;
+  if (time_keeper.confidence(e) == TIME_CONF_HIGH &&
+      weather_fresh_for(e, millis())) {
+    defer_s = weather_fresh_for(e, millis());
+    if (time_keeper.secondsOfHigh(e) < defer_s)
+      defer_s = time_keeper.secondsOfHigh(e);
+    LOGI(LOG_NET, "First sync in %lus", (unsigned long)defer_s);
+    wifi_mgr.assumeHealthy();
+  }
+  wifi_mgr.requestSync(millis() + defer_s * 1000);
+
+  for (;;) {
+    TRACE_BEGIN(TR_NET_TASK);
+    uint8_t ev;
+    while (wifi_events.pop(ev))
+      wifi_apply(wifi_mgr.onEvent(millis(), (WifiEvent)ev));
+    wifi_apply(wifi_mgr.poll(millis()));
+
+    // The indicator shows whether syncs get through (UI only hears about
+    // changes); the radio itself is off most of the time
+    static int last_healthy = -1; // Force the first report
+    bool healthy = wifi_mgr.isHealthy();
+    if ((int)healthy != last_healthy) {
+      last_healthy = healthy;
+      net_publish_link(healthy);
     }
-    xSemaphoreGive(xNetworkMutex);
+    time_persist(false);
+    TRACE_END(TR_NET_TASK);
+
+    uint32_t wait = wifi_mgr.msUntilNext(millis());
+    if (wait > 60000)
+      wait = 60000;
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait));
   }
+}
 
-  if (hasUpdate) {
-    // Apply to all UI elements
-    if (ui_weather_title_group_1) {
-      lv_label_set_text_fmt(
-          ui_comp_get_child(ui_weather_title_group_1, UI_COMP_TITLEGROUP_TITLE),
-          "%s", desc.c_str());
-      lv_label_set_text_fmt(ui_comp_get_child(ui_weather_title_group_1,
-                                              UI_COMP_TITLEGROUP_SUBTITLE),
-                            "Temp: %d C", temp);
+// Apply the home location's weather to the watch faces
+void applyWeatherUI(int temp, const char *desc) {
+  if (ui_weather_title_group_1) {
+    lv_label_set_text_fmt(
+        ui_comp_get_child(ui_weather_title_group_1, UI_COMP_TITLEGROUP_TITLE),
+        "%s", desc);
+    lv_label_set_text_fmt(ui_comp_get_child(ui_weather_title_group_1,
+                                            UI_COMP_TITLEGROUP_SUBTITLE),
+                          "Temp: %d C", temp);
+  }
+  if (ui_weather_title_group_2) {
+    lv_label_set_text_fmt(
+        ui_comp_get_child(ui_weather_title_group_2, UI_COMP_TITLEGROUP_TITLE),
+        "%s", desc);
+    lv_label_set_text_fmt(ui_comp_get_child(ui_weather_title_group_2,
+                                            UI_COMP_TITLEGROUP_SUBTITLE),
+                          "Temp: %d C", temp);
+  }
+  if (ui_degree_7) {
+    // Task 75: Fix Analog Watch Face Weather Text Overflow
+    lv_obj_set_style_text_font(ui_degree_7, &ui_font_Title, 0);
+    lv_label_set_text_fmt(ui_degree_7, "%d°", temp);
+  }
+  // Task 25: Fix Digital Clock Weather Group (Left Widget)
+  // Task 25: Fix Digital Clock Weather Group (Left Widget)
+  // Task 25: Fix Digital Clock Weather Group (Left Widget)
+  if (ui_weather_group_1) {
+    // Child 0 is the group container itself in some generated code,
+    // we use the helper macros to be safe.
+    // UI_COMP_WEATHERGROUP1_DEGREE_1 is the label
+    lv_obj_t *degree_label =
+        ui_comp_get_child(ui_weather_group_1, UI_COMP_WEATHERGROUP1_DEGREE_1);
+    if (degree_label) {
+      // Task 74: Fix Text Overflow (Use Title font which has symbols)
+      lv_obj_set_style_text_font(degree_label, &ui_font_Title, 0);
+      lv_label_set_text_fmt(degree_label, "%d°", temp);
     }
-    if (ui_weather_title_group_2) {
-      lv_label_set_text_fmt(
-          ui_comp_get_child(ui_weather_title_group_2, UI_COMP_TITLEGROUP_TITLE),
-          "%s", desc.c_str());
-      lv_label_set_text_fmt(ui_comp_get_child(ui_weather_title_group_2,
-                                              UI_COMP_TITLEGROUP_SUBTITLE),
-                            "Temp: %d C", temp);
+  }
+  // Serial.println("UI: Weather Updated from Background Task");
+}
+
+// Forecast rows of the second weather screen; rows without data are hidden,
+// all of them when n is 0
+void applyForecastUI(const ForecastDay *days, uint8_t n) {
+  static const char *wdays[] = {"Sun", "Mon", "Tue", "Wed",
+                                "Thu", "Fri", "Sat"};
+  static const lv_img_dsc_t *icons[WX_ICON_COUNT] = {
+      &ui_img_weather_sun_png, &ui_img_weather_sun_cloud_png,
+      &ui_img_weather_cloud_png, &ui_img_weather_cloud_fog_png};
+  lv_obj_t *rows[WEATHER_DAYS] = {ui_forecast_group,  ui_forecast_group1,
+                                  ui_forecast_group2, ui_forecast_group3,
+                                  ui_forecast_group4, ui_forecast_group5};
+  for (uint8_t i = 0; i < WEATHER_DAYS; i++) {
+    if (!rows[i])
+      continue;
+    if (i >= n) {
+      lv_obj_add_flag(rows[i], LV_OBJ_FLAG_HIDDEN);
+      continue;
     }
-    if (ui_weather_title_group_3) {
-      lv_label_set_text_fmt(
-          ui_comp_get_child(ui_weather_title_group_3, UI_COMP_TITLEGROUP_TITLE),
-          "%s", desc.c_str());
+    const ForecastDay &d = days[i];
+    lv_obj_clear_flag(rows[i], LV_OBJ_FLAG_HIDDEN);
+    lv_label_set_text(ui_comp_get_child(rows[i], UI_COMP_FORECASTGROUP_DAY1),
+                      wdays[d.wday]);
+    lv_label_set_text_fmt(
+        ui_comp_get_child(rows[i], UI_COMP_FORECASTGROUP_DEGREE_GROUP_DAYTIME),
+        "%d°", d.hi);
+    lv_label_set_text_fmt(
+        ui_comp_get_child(rows[i],
+                          UI_COMP_FORECASTGROUP_DEGREE_GROUP_NIGHTTIME),
+        "%d°", d.lo);
+    lv_img_set_src(ui_comp_get_child(rows[i], UI_COMP_FORECASTGROUP_CLOUD_SUN),
+                   icons[d.icon]);
+  }
+}
+
+// --- Weather screens page through the locations (UI task only) ---
+uint8_t weather_page = 0;
+NetState net_shown; // Last state updateNetworkUI drew
+
+// City, conditions and forecast of the selected location, from what the UI
+// already holds: paging never waits on the network
+void applyWeatherPageUI() {
+  const NetWeather &w = net_shown.weather[weather_page];
+  const char *name = weather_locations[weather_page].name;
+  lv_obj_t *cities[] = {ui_city_gruop_1, ui_city_gruop_2};
+  for (uint8_t i = 0; i < 2; i++)
+    if (cities[i])
+      lv_label_set_text(
+          ui_comp_get_child(cities[i], UI_COMP_TITLEGROUP_TITLE), name);
+  if (ui_weather_title_group_3) {
+    lv_label_set_text(
+        ui_comp_get_child(ui_weather_title_group_3, UI_COMP_TITLEGROUP_TITLE),
+        w.valid ? w.desc.c_str() : "--");
+    if (w.valid)
       lv_label_set_text_fmt(ui_comp_get_child(ui_weather_title_group_3,
                                               UI_COMP_TITLEGROUP_SUBTITLE),
-                            "Temp: %d C", temp);
-    }
-    if (ui_degree_7) {
-      // Task 75: Fix Analog Watch Face Weather Text Overflow
-      lv_obj_set_style_text_font(ui_degree_7, &ui_font_Title, 0);
-      lv_label_set_text_fmt(ui_degree_7, "%d°", temp);
+                            "Temp: %d C", w.temp);
+    else
+      lv_label_set_text(ui_comp_get_child(ui_weather_title_group_3,
+                                          UI_COMP_TITLEGROUP_SUBTITLE),
+                        "No data yet");
+  }
+  if (ui_label_degree) {
+    lv_obj_set_style_text_font(ui_label_degree, &ui_font_Number_extra, 0);
+    if (w.valid)
+      lv_label_set_text_fmt(ui_label_degree, "%d", w.temp);
+    else
+      lv_label_set_text(ui_label_degree, "--");
+  }
+  applyForecastUI(w.forecast, w.days); // No rows: none left from another
+}
+
+// Tap on the city name: next location
+static void weather_page_cb(lv_event_t *e) {
+  weather_page = (weather_page + 1) % WEATHER_LOCATION_COUNT;
+  applyWeatherPageUI();
+}
+
+// UI Updater (runs in Loop/Core 1). Network state is read only when its
+// snapshot version moved, and only the parts that changed are redrawn.
+// Then the UI bus is drained.
+void updateNetworkUI() {
+  STALL_SCOPE("net_ui");
+  TRACE_SCOPE(TR_NET_UI);
+  static uint32_t seen = 0;
+  NetState &shown = net_shown;
+  static bool link_drawn = false;
+  if (net_state.version() != seen) {
+    NetState s;
+    seen = net_state.read(s);
+    if (!link_drawn || s.linkUp != shown.linkUp) {
+      if (wifi_ind) {
+        // Task 67: Red/Green Indicator (green: last sync got through)
+        lv_obj_set_style_bg_color(wifi_ind,
+                                  s.linkUp ? lv_color_hex(0x00FF00) // Green
+                                           : lv_color_hex(0xFF0000), // Red
+                                  0);
+      }
+      link_drawn = true;
     }
-    if (ui_label_degree) {
-      lv_obj_set_style_text_font(ui_label_degree, &ui_font_Number_extra, 0);
-      lv_label_set_text_fmt(ui_label_degree, "%d", temp);
+    const NetWeather &home = s.weather[0];
+    if (home.valid && !net_weather_same(home, shown.weather[0])) {
+      applyWeatherUI(home.temp, home.desc.c_str());
     }
-    // Task 25: Fix Digital Clock Weather Group (Left Widget)
-    // Task 25: Fix Digital Clock Weather Group (Left Widget)
-    // Task 25: Fix Digital Clock Weather Group (Left Widget)
-    if (ui_weather_group_1) {
-      // Child 0 is the group container itself in some generated code,
-      // we use the helper macros to be safe.
-      // UI_COMP_WEATHERGROUP1_DEGREE_1 is the label
-      lv_obj_t *degree_label =
-          ui_comp_get_child(ui_weather_group_1, UI_COMP_WEATHERGROUP1_DEGREE_1);
-      if (degree_label) {
-        // Task 74: Fix Text Overflow (Use Title font which has symbols)
-        lv_obj_set_style_text_font(degree_label, &ui_font_Title, 0);
-        lv_label_set_text_fmt(degree_label, "%d°", temp);
-      }
+    bool page_changed =
+        !net_weather_same(s.weather[weather_page], shown.weather[weather_page]);
+    if (s.timeSyncs != shown.timeSyncs)
+      sched.reschedule(clock_job, micros()); // Redraw the clock now
+    shown = s;
+    if (page_changed)
+      applyWeatherPageUI();
+  }
+
+  UiEvent ev;
+  while (ui_bus.poll(ev)) {
+    switch (ev.type) {
+    case UI_EV_BLE:
+      LOGI(LOG_UI, "BLE host %s", ev.connected ? "connected" : "gone");
+      reader.onBleLink(ev.connected);
+      break;
     }
-    // Serial.println("UI: Weather Updated from Background Task");
   }
 }
 
@@ -388,28 +1195,22 @@ void updateNetworkUI() {
 
 // Old setupWiFi and wifi_manager removed (replaced by networkTask)
 
+// Runs once per wall-clock second (see job_clock)
 void update_time_ui() {
-  static unsigned long last_update = 0;
-  if (millis() - last_update < 1000)
-    return; // Update every 1s
-  last_update = millis();
-
-  // 1. Update WiFi Indicator
-  if (wifi_ind) {
-    if (WiFi.status() == WL_CONNECTED) {
-      lv_obj_set_style_bg_color(wifi_ind, lv_color_white(), 0);
-    } else {
-      lv_obj_set_style_bg_color(wifi_ind, lv_color_hex(0x555555),
-                                0); // Dim Grey
-    }
-  }
+  TRACE_SCOPE(TR_TIME_UI);
+  // 1. WiFi Indicator is event driven (see updateNetworkUI)
 
   // 2. Get System Time (Passive Logic Task 35)
   struct tm timeinfo = {0};
 
   // Just ask for time. If it fails, use system time (likely 1970).
   // This ensures the animation loop NEVER stops.
-  if (!getLocalTime(&timeinfo, 10)) {
+  bool have_time;
+  {
+    STALL_SCOPE("localtime"); // Waits up to 10ms while time is unset
+    have_time = getLocalTime(&timeinfo, 10);
+  }
+  if (!have_time) {
     time_t now;
     time(&now);
     localtime_r(&now, &timeinfo);
@@ -424,7 +1225,7 @@ void update_time_ui() {
                                 timeinfo.tm_mon + 1);
     updateCalendarTitle(); // Refresh the dynamic title
     calendar_synced = true;
-    Serial.println("Calendar Synced to System Time.");
+    LOGI(LOG_UI, "Calendar Synced to System Time.");
   }
 
   // Task 70: UI Debugging (Disabled)
@@ -498,19 +1299,14 @@ void update_time_ui() {
     ui_calendar_update_today(1900 + timeinfo.tm_year, timeinfo.tm_mon + 1,
                              timeinfo.tm_mday);
 
-    // Update City/Date labels on weather screens
+    // Update Date labels on weather screens (the city is the selected
+    // location, see applyWeatherPageUI)
     if (ui_city_gruop_1) {
-      lv_label_set_text(
-          ui_comp_get_child(ui_city_gruop_1, UI_COMP_TITLEGROUP_TITLE),
-          "Bengaluru");
       strftime(buf, sizeof(buf), "%d. %m. %A", &timeinfo);
       lv_label_set_text(
           ui_comp_get_child(ui_city_gruop_1, UI_COMP_TITLEGROUP_SUBTITLE), buf);
     }
     if (ui_city_gruop_2) {
-      lv_label_set_text(
-          ui_comp_get_child(ui_city_gruop_2, UI_COMP_TITLEGROUP_TITLE),
-          "Bengaluru");
       strftime(buf, sizeof(buf), "%d. %m. %A", &timeinfo);
       lv_label_set_text(
           ui_comp_get_child(ui_city_gruop_2, UI_COMP_TITLEGROUP_SUBTITLE), buf);
@@ -542,22 +1338,6 @@ void update_time_ui() {
     }
   }
 
-  // Update battery only periodically (or if it were real data, on change)
-  static uint32_t last_batt_update = 0;
-  if (millis() - last_batt_update > 60000) {
-    if (ui_battery_group) {
-      lv_label_set_text(ui_comp_get_child(ui_battery_group,
-                                          UI_COMP_BATTERYGROUP_BATTERY_PERCENT),
-                        "100%");
-    }
-    if (ui_battery_group1) {
-      lv_label_set_text(ui_comp_get_child(ui_battery_group1,
-                                          UI_COMP_BATTERYGROUP_BATTERY_PERCENT),
-                        "100%");
-    }
-    last_batt_update = millis();
-  }
-
   last_h12 = h12;
   last_min = timeinfo.tm_min;
   last_sec = timeinfo.tm_sec;
@@ -571,11 +1351,11 @@ void CHSC5816_Initialization(void) {
 
   touch.setPins(TOUCH_RST, TOUCH_INT);
   if (!touch.begin(Wire, CHSC5816_SLAVE_ADDRESS, IIC_SDA, IIC_SCL)) {
-    Serial.println(
-        "Failed to find CHSC5816 - Hardware mismatch or wiring issue!");
+    LOGE(LOG_SYS,
+         "Failed to find CHSC5816 - Hardware mismatch or wiring issue!");
     // DO NOT HANG HERE - allow display to continue
   } else {
-    Serial.println("Touch Sensor Initialized.");
+    LOGI(LOG_SYS, "Touch Sensor Initialized.");
   }
 }
 
@@ -583,10 +1363,35 @@ void lv_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area,
                    lv_color_t *color_p) {
   uint32_t w = (area->x2 - area->x1 + 1);
   uint32_t h = (area->y2 - area->y1 + 1);
-  lcd_PushColors(area->x1, area->y1, w, h, (uint16_t *)&color_p->full);
+  {
+    STALL_SCOPE("flush");
+    TRACE_SCOPE(TR_FLUSH);
+    frames.beginFlush(micros());
+    lcd_PushColors(area->x1, area->y1, w, h, (uint16_t *)&color_p->full);
+    frames.endFlush(micros(), w * h);
+  }
+  latency.onFlush(area->x1, area->y1, area->x2, area->y2, micros(),
+                  lv_scr_act());
   lv_disp_flush_ready(disp);
 }
 
+// Link an input to the next flush of obj's screen that touches obj, the
+// object the input is expected to change (a screen for a screen load)
+static void latency_arm(InputKind kind, uint32_t input_us, lv_obj_t *obj) {
+  if (!obj)
+    return;
+  lv_area_t a;
+  lv_obj_get_coords(obj, &a);
+  latency.arm(kind, input_us, lv_obj_get_screen(obj), a.x1, a.y1, a.x2,
+              a.y2);
+}
+
+static uint32_t take_encoder_stamp() {
+  uint32_t t = encoder_input_us;
+  encoder_input_us = 0;
+  return t;
+}
+
 void my_rounder(lv_disp_drv_t *disp_drv, lv_area_t *area) {
 
   area->x1 =
@@ -719,47 +1524,121 @@ static void ui_event_settings_redirect(lv_event_t *e) {
   }
 }
 
+// Touch state injected by session replay (replaces the CHSC5816 reading)
+struct ReplayTouch {
+  bool pressed;
+  bool fresh; // Set by the replay pump, cleared once LVGL has read it
+  int16_t x, y;
+};
+ReplayTouch replay_touch = {false, false, 0, 0};
+
 static void lv_indev_read(lv_indev_drv_t *indev_driver, lv_indev_data_t *data) {
+  TRACE_SCOPE(TR_INDEV);
   int16_t Touch_x[2], Touch_y[2];
-  uint8_t touchpad = touch.getPoint(Touch_x, Touch_y);
-
-  static uint32_t press_start = 0;
-  static bool was_pressed = false;
+  uint8_t touchpad;
+  uint32_t now = millis();
+
+  if (session.isReplaying()) {
+    touchpad = replay_touch.pressed;
+    Touch_x[0] = replay_touch.x;
+    Touch_y[0] = replay_touch.y;
+    replay_touch.fresh = false;
+  } else {
+    touchpad = touch.getPoint(Touch_x, Touch_y);
+    static bool rec_pressed = false;
+    static int16_t rec_x = -1, rec_y = -1;
+    if (touchpad > 0 &&
+        (!rec_pressed || Touch_x[0] != rec_x || Touch_y[0] != rec_y)) {
+      session.record(now, REC_TOUCH, Touch_x[0], Touch_y[0]);
+      rec_x = Touch_x[0];
+      rec_y = Touch_y[0];
+    } else if (touchpad == 0 && rec_pressed) {
+      session.record(now, REC_RELEASE);
+    }
+    rec_pressed = touchpad > 0;
+  }
 
+  // Only note the sample here; gestures are acted on from loop()
   if (touchpad > 0) {
+    if (!gestures.isTouching()) { // Touch-down: first redraw under finger
+      latency.arm(INPUT_TOUCH, micros(), lv_scr_act(), Touch_x[0] - 20,
+                  Touch_y[0] - 20, Touch_x[0] + 20, Touch_y[0] + 20);
+    }
+    gestures.feed(now, true, Touch_x[0], Touch_y[0]);
+    touchFilter.apply(now, Touch_x[0], Touch_y[0]); // De-jitter for LVGL
     data->state = LV_INDEV_STATE_PR;
     data->point.x = Touch_x[0];
     data->point.y = Touch_y[0];
-
-    if (!was_pressed) {
-      press_start = millis();
-      was_pressed = true;
-    }
   } else {
     data->state = LV_INDEV_STATE_REL;
-    if (was_pressed) {
-      uint32_t duration = millis() - press_start;
-      if (lv_scr_act() == ui_pet_screen) {
-        if (duration < 500) { // Short Tap -> Happy
-          if (pet.getMood() != SLEEPY) {
-            pet.setMood(HAPPY);
-            squeak();
-          } else {
-            // Wake up if tapped while sleeping? Or ignore?
-            // Let's wake up on long press, maybe just ignore short tap or grunt
-            snore();
-          }
-        } else if (duration > 800) { // Long Press -> Sleep/Wake
-          if (pet.getMood() == SLEEPY) {
-            pet.setMood(NEUTRAL); // Wake up
-            squeak();
-          } else {
-            pet.setMood(SLEEPY); // Go to sleep
-            snore();
-          }
-        }
+    gestures.feed(now, false, 0, 0);
+    touchFilter.release();
+  }
+}
+
+// Drain recognised gestures outside the input read callback
+void handleGestures() {
+  GestureEvent ev;
+  while (gestures.poll(ev)) {
+    if (lv_scr_act() != ui_pet_screen)
+      continue;
+
+    switch (ev.type) {
+    case GESTURE_TAP: // Short Tap -> Happy
+      if (pet.getMood() != SLEEPY) {
+        pet.setMood(HAPPY);
+        squeak();
+      } else {
+        snore();
+      }
+      break;
+    case GESTURE_LONG_PRESS: // Long Press -> Sleep/Wake
+      if (pet.getMood() == SLEEPY) {
+        pet.setMood(NEUTRAL); // Wake up
+        squeak();
+      } else {
+        pet.setMood(SLEEPY); // Go to sleep
+        snore();
       }
-      was_pressed = false;
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+// Act on knob clicks queued by the button timer
+void handleButtonEvents() {
+  ButtonEvent ev;
+  while (knobButton.poll(ev)) {
+    switch (ev.type) {
+    case BTN_PRESS:
+    case BTN_RELEASE:
+      session.record(ev.timestamp, REC_BUTTON, ev.type == BTN_PRESS);
+      break;
+    case BTN_LONG: // Hold -> Reader scroll lock toggle
+      if (reader.getIsActive()) {
+        latency_arm(INPUT_BUTTON,
+                    knob_press_us + knobButton.cfg.longPressMs * 1000UL,
+                    reader.getModeLabel());
+        reader.onButtonPress();
+      }
+      break;
+    case BTN_SINGLE: // Click -> Calendar focus toggle
+      if (!reader.getIsActive() && lv_scr_act() == ui_calendar_screen)
+        encoder_has_focus = !encoder_has_focus;
+      break;
+    case BTN_DOUBLE: // Double click -> Calendar back to today's month
+      if (lv_scr_act() == ui_calendar_screen) {
+        latency_arm(INPUT_BUTTON, knob_release_us, ui_calendar);
+        const lv_calendar_date_t *today =
+            lv_calendar_get_today_date(ui_calendar);
+        lv_calendar_set_showed_date(ui_calendar, today->year, today->month);
+        updateCalendarTitle();
+      }
+      break;
+    default:
+      break;
     }
   }
 }
@@ -796,30 +1675,14 @@ void create_pet_layer() {
   lv_obj_align(eye_right, LV_ALIGN_CENTER, 35, 0);
 }
 
-void pet_loop_logic() {
-  // Button Handler
-  static bool last_btn_state = HIGH;
-  bool btn_state = digitalRead(KNOB_KEY);
-
-  // Reader Mode Toggle (Debounced in logic or here)
-  if (last_btn_state == HIGH && btn_state == LOW) { // Press
-    // If Reader App is active, toggle mode
-    if (reader.getIsActive()) {
-      reader.onButtonPress();
-      delay(50); // Simple debounce
-    }
-  }
-  last_btn_state = btn_state;
-
-  // Update Engines
-  pet.update();
-  reader.update();
-}
-
 void setup() {
   // Buzzer setup (Core 2.x API)
   ledcSetup(0, 2000, 8); // Channel 0, 2000Hz, 8-bit
   ledcAttachPin(BUZZER_DATA, 0);
+  esp_timer_create_args_t buzzer_args = {};
+  buzzer_args.callback = buzzer_timer_cb;
+  buzzer_args.name = "buzzer";
+  esp_timer_create(&buzzer_args, &buzzer_timer);
 
   pinMode(LCD_VCI_EN, OUTPUT);
   digitalWrite(LCD_VCI_EN, HIGH); // enable display hardware
@@ -829,41 +1692,46 @@ void setup() {
 
   Serial.begin(115200);
   delay(500);
-  Serial.println("Booting DeskPet...");
+  // Drain the log from core 0 so setup traces don't wait on USB CDC
+  xTaskCreatePinnedToCore(logTask, "Log", 3072, NULL, 1, &log_task, 0);
+  LOGI(LOG_SYS, "Booting DeskPet...");
+  time_restore(); // RTC / NVS, before anything draws the clock
 
   // Init BLE Mouse
   // Init BLE Mouse
-  Serial.println("Init BLE Mouse...");
+  LOGI(LOG_SYS, "Init BLE Mouse...");
   // bleMouse.begin(); // LAZY INIT: Started by ReaderEngine on demand
 
-  Serial.println("Init Touch...");
+  LOGI(LOG_SYS, "Init Touch...");
   CHSC5816_Initialization();
 
-  Serial.println("Init Display...");
+  LOGI(LOG_SYS, "Init Display...");
   sh8601_init();
   lcd_brightness(200);
 
-  Serial.println("Init LVGL...");
+  LOGI(LOG_SYS, "Init LVGL...");
   lv_init();
 
-  Serial.println("Allocating Framebuffer...");
+  LOGI(LOG_SYS, "Allocating Framebuffer...");
   size_t buf_size = sizeof(lv_color_t) * LVGL_LCD_BUF_SIZE;
   // Prefer SPIRAM (PSRAM) for this large buffer
-  buf = (lv_color_t *)heap_caps_malloc(buf_size, MALLOC_CAP_SPIRAM);
+  buf = (lv_color_t *)heap_account.alloc(HEAP_DISPLAY, buf_size,
+                                         MALLOC_CAP_SPIRAM);
   if (!buf) {
-    Serial.println("PSRAM allocation failed! Trying internal RAM...");
-    buf = (lv_color_t *)heap_caps_malloc(buf_size, MALLOC_CAP_INTERNAL);
+    LOGW(LOG_SYS, "PSRAM allocation failed! Trying internal RAM...");
+    buf = (lv_color_t *)heap_account.alloc(HEAP_DISPLAY, buf_size,
+                                           MALLOC_CAP_INTERNAL);
   }
 
   if (!buf) {
-    Serial.println("FATAL: Memory allocation failed for display buffer!");
+    LOGE(LOG_SYS, "FATAL: Memory allocation failed for display buffer!");
     while (1)
       delay(1000);
   }
 
   lv_disp_draw_buf_init(&draw_buf, buf, NULL, LVGL_LCD_BUF_SIZE);
 
-  Serial.println("Registering Display Driver...");
+  LOGI(LOG_SYS, "Registering Display Driver...");
   static lv_disp_drv_t disp_drv;
   lv_disp_drv_init(&disp_drv);
   disp_drv.hor_res = EXAMPLE_LCD_H_RES;
@@ -872,14 +1740,14 @@ void setup() {
   disp_drv.draw_buf = &draw_buf;
   lv_disp_drv_register(&disp_drv);
 
-  Serial.println("Registering Input Device...");
+  LOGI(LOG_SYS, "Registering Input Device...");
   static lv_indev_drv_t indev_drv;
   lv_indev_drv_init(&indev_drv);
   indev_drv.type = LV_INDEV_TYPE_POINTER;
   indev_drv.read_cb = lv_indev_read;
   lv_indev_drv_register(&indev_drv);
 
-  Serial.println("Initializing UI Components...");
+  LOGI(LOG_SYS, "Initializing UI Components...");
   ui_init();
 
   if (ui_watch_digital) {
@@ -892,17 +1760,44 @@ void setup() {
     lv_obj_clear_flag(wifi_ind, LV_OBJ_FLAG_SCROLLABLE);
   }
 
-  Serial.println("Creating Pet App Screen...");
-  ui_pet_screen = lv_obj_create(NULL); // Create as a top-level screen
-  pet.init(ui_pet_screen);
+  LOGI(LOG_SYS, "Creating Pet App Screen...");
+  {
+    HeapTagScope tag(&lv_heap_tag, HEAP_ENGINES);
+    ui_pet_screen = lv_obj_create(NULL); // Create as a top-level screen
+    pet.init(ui_pet_screen);
+  }
 
-  Serial.println("Creating Reader App Screen...");
-  ui_reader_screen = lv_obj_create(NULL);
-  reader.init(ui_reader_screen);
+  LOGI(LOG_SYS, "Creating Reader App Screen...");
+  {
+    HeapTagScope tag(&lv_heap_tag, HEAP_ENGINES);
+    ui_reader_screen = lv_obj_create(NULL);
+    reader.init(ui_reader_screen);
+  }
 
-  Serial.println("Creating Calendar App Screen...");
+  LOGI(LOG_SYS, "Creating Calendar App Screen...");
   ui_calendar_screen_init(); // Pre-initialize Calendar
 
+  weather_cache_restore();
+
+  // Screen names for the latency and frame timing reports
+  struct {
+    lv_obj_t *screen;
+    const char *name;
+  } screen_names[] = {
+      {ui_watch_digital, "digital"},
+      {ui_watch_analog, "analog"},
+      {ui_pet_screen, "pet"},
+      {ui_weather_1, "weather1"},
+      {ui_weather_2, "weather2"},
+      {ui_reader_screen, "reader"},
+      {ui_calendar_screen, "calendar"},
+      {ui_call, "settings"},
+  };
+  for (auto &n : screen_names) {
+    latency.nameScreen(n.screen, n.name);
+    frames.nameScreen(n.screen, n.name);
+  }
+
   // Repurpose Call Button to Settings on Digital Watch
   if (ui_button_top) {
     lv_obj_t *icon =
@@ -942,55 +1837,62 @@ void setup() {
                         LV_EVENT_CLICKED, NULL);
   }
 
+  // Weather screens: tap the city name for the next location
+  lv_obj_t *cities[] = {ui_city_gruop_1, ui_city_gruop_2};
+  for (uint8_t i = 0; i < 2; i++) {
+    if (!cities[i])
+      continue;
+    lv_obj_add_flag(cities[i], LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(cities[i], weather_page_cb, LV_EVENT_CLICKED, NULL);
+  }
+  applyWeatherPageUI(); // Names before any weather arrives
+
   lv_timer_handler();
   delay(200);
   lv_timer_handler();
 
-  // Create Mutex and Network Task
-  Serial.println("setup: Creating Network Task...");
-  xNetworkMutex = xSemaphoreCreateMutex();
+  time_lock = xSemaphoreCreateMutex();
+  // Create Network Task (reports to the UI through net_state)
+  LOGI(LOG_SYS, "Creating Network Task...");
   xTaskCreatePinnedToCore(networkTask,   // Function
                           "NetworkTask", // Name
                           8192,          // Stack (Web requests need space)
                           NULL,          // Params
                           1,             // Priority (Low)
-                          NULL,          // Handle
+                          &net_task,     // Handle (task monitor)
                           0              // Core 0 (System Core)
   );
 
-  Serial.println("Finishing Setup...");
+  LOGI(LOG_SYS, "Finishing Setup...");
+  ui_task = xTaskGetCurrentTaskHandle();
   encoder_init();
-  Serial.println("Setup Complete.");
+  setup_jobs();
+  LOGI(LOG_SYS, "Setup Complete.");
 }
 
 void loop() {
   // Task 18: Service UI first/always
-  lv_timer_handler();
+  stalls.loopMark();
+  uint32_t lv_wait_ms;
+  {
+    STALL_SCOPE("lvgl"); // Render (flush is its own scope)
+    TRACE_SCOPE(TR_LVGL);
+    frames.beginPass(micros());
+    lv_wait_ms = lv_timer_handler();
+    frames.endPass(micros(), lv_scr_act());
+  }
 
-  // Task 16: Heartbeat
-  static unsigned long last_heartbeat = 0;
-  if (millis() - last_heartbeat > 5000) {
-    Serial.printf("UI Core Heartbeat: %lu\n", millis());
-    last_heartbeat = millis();
-  }
-
-  // 1. Button Logic (Reader Toggle)
-  static bool last_btn_state = HIGH;
-  static unsigned long last_btn_time = 0;
-  bool btn_state = digitalRead(KNOB_KEY);
-
-  if (btn_state != last_btn_state) {
-    if (millis() - last_btn_time > 50) { // 50ms Debounce
-      if (btn_state == LOW) {            // Press
-        if (reader.getIsActive()) {
-          reader.onButtonPress();
-        } else if (lv_scr_act() == ui_calendar_screen) {
-          encoder_has_focus = !encoder_has_focus;
-        }
-      }
-      last_btn_time = millis();
-      last_btn_state = btn_state;
-    }
+  // 0. Session record / replay of inputs
+  {
+    STALL_SCOPE("session");
+    pumpSessionReplay();
+    recordSessionInputs();
+  }
+
+  // 1. Button Logic (Interrupt driven, see knobTimerCallback)
+  {
+    STALL_SCOPE("buttons");
+    handleButtonEvents();
   }
 
   // 2. Encoder Logic
@@ -1002,6 +1904,7 @@ void loop() {
     if (current_pos != last_handled_pos) {
       int diff = (current_pos - last_handled_pos);
       // int scroll_ticks = diff / 2; // REMOVED QUANTIZATION FOR SMOOTHNESS
+      take_encoder_stamp(); // Remote scroll, nothing redrawn locally
       reader.onScroll(diff);
       last_handled_pos = current_pos;
     }
@@ -1011,6 +1914,7 @@ void loop() {
     if (is_settings_mode && ui_brightness_slider) {
       if (current_pos != last_handled_pos) {
         int diff = (current_pos - last_handled_pos);
+        latency_arm(INPUT_ENCODER, take_encoder_stamp(), ui_brightness_slider);
         int val = lv_slider_get_value(ui_brightness_slider);
         val += (diff * 5); // 5% per click
         val = constrain(val, 0, 100);
@@ -1019,7 +1923,10 @@ void loop() {
 
         // Update Brightness Immediately
         global_brightness = map(val, 0, 100, 10, 255);
-        lcd_brightness(global_brightness);
+        {
+          STALL_SCOPE("brightness"); // SPI command to the panel
+          lcd_brightness(global_brightness);
+        }
         if (ui_volume_percent) {
           lv_label_set_text_fmt(ui_volume_percent, "%d%%", val);
         }
@@ -1028,6 +1935,7 @@ void loop() {
       }
     } else if (lv_scr_act() == ui_calendar_screen) {
       if (current_pos != last_handled_pos) {
+        latency_arm(INPUT_ENCODER, take_encoder_stamp(), ui_calendar);
         if (current_pos > last_handled_pos) {
           // Next Month
           const lv_calendar_date_t *d =
@@ -1058,6 +1966,7 @@ void loop() {
         last_handled_pos = current_pos;
       }
     } else {
+      take_encoder_stamp();
       last_handled_pos = current_pos; // Absorb events
     }
   }
@@ -1073,7 +1982,10 @@ void loop() {
         current_app_index = MAX_APPS - 1;
     }
 
+    uint32_t input_us = take_encoder_stamp();
+
     // Switch Logic
+    STALL_SCOPE("screen_load");
     // Cleanup active app
     pet.onAppLeave();
     reader.onAppLeave();
@@ -1109,6 +2021,12 @@ void loop() {
                         &ui_calendar_screen_init);
       break;
     }
+    // Ends at the first frame of the new screen, not a redraw of the old one
+    static lv_obj_t **const app_screens[MAX_APPS] = {
+        &ui_watch_digital, &ui_watch_analog,  &ui_pet_screen,
+        &ui_weather_1,     &ui_weather_2,     &ui_reader_screen,
+        &ui_calendar_screen};
+    latency_arm(INPUT_ENCODER, input_us, *app_screens[current_app_index]);
 
     last_handled_pos = current_pos;
   }
@@ -1116,17 +2034,549 @@ void loop() {
   // 3. Update Engines & Maintenance
   // lv_timer_handler(); // Moved to top
   // delay(5); // Remove potential jitter maker
+  {
+    STALL_SCOPE("gestures");
+    handleGestures();
+  }
+
+  // 4. Update UI from Background Data (only when something changed)
+  poll_ble_link();
+  updateNetworkUI();
+
+  // 5. Periodic work (engines, clock, network UI; see setup_jobs)
+  reader_job_sync();
+  uint32_t job_wait_us = sched.runDue(micros);
+
+  ui_wait(lv_wait_ms, job_wait_us);
+}
+
+// -------------------------------------------------------------------------
+// TASK MONITOR (CPU share per core, stack headroom)
+// -------------------------------------------------------------------------
+// Per-task CPU share needs CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS, which
+// the prebuilt Arduino core leaves off. To get it, build the core from
+// source with that option (ESP-IDF + Arduino as a component, or the
+// Arduino lib-builder) and flash that. Without it the tick hooks below
+// sample which task each tick interrupts, giving the core loads only.
+#ifndef TASK_MONITOR
+#define TASK_MONITOR 1
+#endif
+#ifndef TASK_MONITOR_PERIOD_MS
+#define TASK_MONITOR_PERIOD_MS 10000
+#endif
+#ifndef TASK_STACK_WARN_BYTES
+#define TASK_STACK_WARN_BYTES 768
+#endif
+#ifndef TASK_CPU_WARN_PCT
+#define TASK_CPU_WARN_PCT 90
+#endif
+
+TaskMonitor task_monitor(TASK_STACK_WARN_BYTES, TASK_CPU_WARN_PCT);
+
+#if TASK_MONITOR
+static int8_t task_core(TaskHandle_t t) {
+  BaseType_t core = xTaskGetAffinity(t);
+  return core == tskNO_AFFINITY ? -1 : (int8_t)core;
+}
+
+#if !configGENERATE_RUN_TIME_STATS
+static volatile uint32_t idle_ticks[2], all_ticks[2];
+
+static void IRAM_ATTR count_tick() {
+  BaseType_t core = xPortGetCoreID();
+  all_ticks[core]++;
+  if (xTaskGetCurrentTaskHandleForCPU(core) ==
+      xTaskGetIdleTaskHandleForCPU(core))
+    idle_ticks[core]++;
+}
+#endif
+
+static void start_task_monitor() {
+#if !configGENERATE_RUN_TIME_STATS
+  esp_register_freertos_tick_hook_for_cpu(count_tick, 0);
+  esp_register_freertos_tick_hook_for_cpu(count_tick, 1);
+#endif
+}
+
+static void sample_tasks() {
+  static TaskSample samples[TaskMonitor::MAX_TASKS];
+  uint8_t n = 0;
+  uint32_t total = 0;
+#if configUSE_TRACE_FACILITY
+  // Needs room for every task or it returns nothing
+  static TaskStatus_t status[TaskMonitor::MAX_TASKS];
+  UBaseType_t got =
+      uxTaskGetSystemState(status, TaskMonitor::MAX_TASKS, &total);
+  for (UBaseType_t i = 0; i < got; i++) {
+    TaskSample &s = samples[n++];
+    s.id = status[i].xTaskNumber;
+    s.name = status[i].pcTaskName;
+    s.core = task_core(status[i].xHandle);
+#if configGENERATE_RUN_TIME_STATS
+    s.runTime = status[i].ulRunTimeCounter;
+#else
+    s.runTime = 0;
+#endif
+    s.stackFree = status[i].usStackHighWaterMark; // Bytes on ESP-IDF
+  }
+#if !configGENERATE_RUN_TIME_STATS
+  total = 0;
+#endif
+#else
+  // No trace facility: only our own tasks, stack only
+  TaskHandle_t own[] = {ui_task, net_task, log_task};
+  for (uint8_t i = 0; i < 3; i++) {
+    if (!own[i])
+      continue;
+    TaskSample &s = samples[n++];
+    s.id = i + 1;
+    s.name = pcTaskGetName(own[i]);
+    s.core = task_core(own[i]);
+    s.runTime = 0;
+    s.stackFree = uxTaskGetStackHighWaterMark(own[i]);
+  }
+#endif
+
+  uint8_t warn = task_monitor.update(samples, n, total);
+#if !configGENERATE_RUN_TIME_STATS
+  uint32_t idle[2] = {idle_ticks[0], idle_ticks[1]};
+  uint32_t ticks[2] = {all_ticks[0], all_ticks[1]};
+  warn |= task_monitor.updateIdle(idle, ticks);
+#endif
+  if (warn & 1) {
+    for (uint8_t i = 0; i < task_monitor.size(); i++) {
+      const TaskStat &t = task_monitor.task(i);
+      if (t.stackWarned)
+        LOGW(LOG_SYS, "Task %s stack low: %lu bytes free", t.name,
+             (unsigned long)t.stackFree);
+    }
+  }
+  for (uint8_t c = 0; c < 2; c++)
+    if (warn & (2 << c))
+      LOGW(LOG_SYS, "Core %u load %.1f%%", c, task_monitor.load(c));
+}
+
+static void job_tasks(void *) {
+  STALL_SCOPE("tasks");
+  sample_tasks();
+}
+#endif
+
+// -------------------------------------------------------------------------
+// UI SCHEDULER JOBS
+// -------------------------------------------------------------------------
+// Microseconds until the wall clock rolls over to the next second
+static uint32_t us_to_next_second() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return 1000000 - tv.tv_usec + 2000; // Land just after the boundary
+}
+
+static void job_heartbeat(void *) { // Task 16: Heartbeat
+  STALL_SCOPE("heartbeat");
+  TRACE_COUNTER(TR_FREE_HEAP, ESP.getFreeHeap());
+  LOGI(LOG_SYS, "UI Core Heartbeat: %lu | idle %.1f%%", millis(),
+       sched.takeIdlePercent(micros()));
+}
+
+static void job_clock(void *) {
+  STALL_SCOPE("clock");
+  update_time_ui();
+  sched.reschedule(clock_job, micros() + us_to_next_second());
+}
+
+// Update battery only periodically (or if it were real data, on change)
+static void job_battery(void *) {
+  STALL_SCOPE("battery");
+  if (ui_battery_group) {
+    lv_label_set_text(ui_comp_get_child(ui_battery_group,
+                                        UI_COMP_BATTERYGROUP_BATTERY_PERCENT),
+                      "100%");
+  }
+  if (ui_battery_group1) {
+    lv_label_set_text(ui_comp_get_child(ui_battery_group1,
+                                        UI_COMP_BATTERYGROUP_BATTERY_PERCENT),
+                      "100%");
+  }
+}
+
+static void job_pet(void *) {
+  STALL_SCOPE("pet");
+  TRACE_SCOPE(TR_PET);
+  HeapTagScope tag(&lv_heap_tag, HEAP_ENGINES);
   pet.update();
+}
+
+static void job_reader(void *) { // Scroll send is 15ms
+  STALL_SCOPE("reader");
+  TRACE_SCOPE(TR_READER);
+  HeapTagScope tag(&lv_heap_tag, HEAP_ENGINES);
   reader.update();
+  if (!reader.needsUpdate()) { // App closed and nothing queued
+    sched.cancel(reader_job);
+    reader_job = -1;
+  }
+}
+
+// Start the reader tick when its app opens or it queues HID reports
+void reader_job_sync() {
+  if (reader_job < 0 && reader.needsUpdate())
+    reader_job = sched.every("reader", 8000, job_reader, NULL, micros());
+}
+
+static void job_serial(void *) {
+  STALL_SCOPE("serial");
+  handleSerialCommands();
+}
+
+void setup_jobs() {
+  uint32_t now = micros();
+  sched.every("heartbeat", 5000000, job_heartbeat, NULL, now + 5000000);
+  clock_job = sched.every("clock", 1000000, job_clock, NULL, now);
+  sched.every("battery", 60000000, job_battery, NULL, now);
+  sched.every("pet", 50000, job_pet, NULL, now);
+  sched.every("serial", 50000, job_serial, NULL, now);
+#if TASK_MONITOR
+  start_task_monitor();
+  sched.every("tasks", TASK_MONITOR_PERIOD_MS * 1000UL, job_tasks, NULL, now);
+#endif
+}
 
-  static unsigned long last_ui_update = 0;
-  if (millis() - last_ui_update > 500) {
-    update_time_ui();
-    last_ui_update = millis();
+// Block until the next LVGL timer, the next job or an input notification
+void ui_wait(uint32_t lv_wait_ms, uint32_t job_wait_us) {
+  uint32_t wait_ms =
+      job_wait_us == Scheduler::NO_JOB ? 100 : (job_wait_us + 999) / 1000;
+  if (lv_wait_ms < wait_ms)
+    wait_ms = lv_wait_ms;
+  if (session.isReplaying() && wait_ms > 5)
+    wait_ms = 5; // Keep replay timing tight
+  if (wait_ms == 0)
+    return;
+
+  uint32_t t0 = micros();
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms));
+  uint32_t idle = micros() - t0;
+  sched.addIdle(idle);
+  stalls.addIdle(idle);
+  frames.addIdle(idle);
+}
+
+// -------------------------------------------------------------------------
+// SESSION RECORD / REPLAY
+// -------------------------------------------------------------------------
+#define SESSION_BUF_SIZE (64 * 1024)
+#define SESSION_FILE "/session.bin"
+
+// Encoder changes are sampled here; touch and button are recorded where they
+// are read.
+void recordSessionInputs() {
+  if (!session.isRecording())
+    return;
+  uint32_t now = millis();
+
+  static int rec_pos = 0;
+  int pos = encoderPos;
+  if (pos != rec_pos) {
+    session.record(now, REC_ENCODER, pos - rec_pos);
+    rec_pos = pos;
   }
+}
 
-  // 4. Update UI from Background Data
-  updateNetworkUI();
+// Feed due replay records into the same paths the hardware uses. Touch
+// records are handed over one per indev read so no press is skipped.
+void pumpSessionReplay() {
+  if (!session.isReplaying() || replay_touch.fresh)
+    return;
+  uint32_t now = millis();
+  SessionRecord r;
+  while (session.nextDue(now, r)) {
+    bool touch_step = false;
+    switch (r.type) {
+    case REC_TOUCH:
+      replay_touch.pressed = true;
+      replay_touch.x = r.a;
+      replay_touch.y = r.b;
+      touch_step = true;
+      break;
+    case REC_RELEASE:
+      replay_touch.pressed = false;
+      touch_step = true;
+      break;
+    case REC_ENCODER:
+      encoderPos += r.a;
+      encoder_input_us = micros();
+      break;
+    case REC_BUTTON:
+      knob_replay_level(r.a);
+      break;
+    }
+    if (touch_step) {
+      replay_touch.fresh = true;
+      break;
+    }
+  }
+
+  if (!session.isReplaying()) {
+    replay_touch.pressed = false;
+    knob_replay_mode(false);
+    LOGI(LOG_SESSION, "Replay finished");
+    LogPrinter out(LOG_SESSION);
+    latency.report(out);
+  }
+}
+
+static bool session_attach() {
+  static uint8_t *buf = NULL;
+  if (!buf) {
+    buf = (uint8_t *)heap_account.alloc(HEAP_DEBUG, SESSION_BUF_SIZE,
+                                        MALLOC_CAP_SPIRAM);
+    if (!buf) {
+      LOGE(LOG_SESSION, "buffer allocation failed");
+      return false;
+    }
+    session.attach(buf, SESSION_BUF_SIZE);
+  }
+  return true;
+}
+
+// Sessions are kept on SPIFFS so they survive flashing a new firmware
+static void session_save() {
+  if (!SPIFFS.begin(true))
+    return;
+  File f = SPIFFS.open(SESSION_FILE, FILE_WRITE);
+  if (f) {
+    f.write(session.data(), session.length());
+    f.close();
+  }
+}
+
+static bool session_load() {
+  if (!SPIFFS.begin(true))
+    return false;
+  File f = SPIFFS.open(SESSION_FILE, FILE_READ);
+  if (!f)
+    return false;
+  size_t n = f.size();
+  bool ok = false;
+  if (n <= SESSION_BUF_SIZE) {
+    uint8_t *tmp =
+        (uint8_t *)heap_account.alloc(HEAP_DEBUG, n, MALLOC_CAP_SPIRAM);
+    if (tmp) {
+      f.read(tmp, n);
+      ok = session.load(tmp, n);
+      heap_account.free(tmp);
+    }
+  }
+  f.close();
+  return ok;
+}
+
+static void session_toggle_record() {
+  if (session.isRecording()) {
+    session.stopRecording();
+    session_save();
+    LOGI(LOG_SESSION, "Stopped, %lu bytes saved",
+         (unsigned long)session.length());
+  } else if (session_attach() && session.startRecording(millis())) {
+    LOGI(LOG_SESSION, "Recording...");
+  }
+}
+
+static void session_replay() {
+  if (!session_attach())
+    return;
+  if (session.length() == 0 && !session_load()) {
+    LOGI(LOG_SESSION, "Nothing to replay");
+    return;
+  }
+  if (session.startReplay(millis())) {
+    knob_replay_mode(true);
+    LOGI(LOG_SESSION, "Replaying %lu bytes",
+         (unsigned long)session.length());
+  }
+}
+
+static void session_dump() {
+  Serial.printf("SESSION %lu\n", (unsigned long)session.length());
+  for (uint32_t i = 0; i < session.length(); i++) {
+    Serial.printf("%02x", session.data()[i]);
+    if (i % 32 == 31)
+      Serial.println();
+  }
+  Serial.println();
+  Serial.println("END");
+}
+
+// -------------------------------------------------------------------------
+// ACTIVITY TRACE
+// -------------------------------------------------------------------------
+#define TRACE_RECORDS 8192 // 96 KB in PSRAM, power of two
+
+static void trace_toggle() {
+  if (tracer.isRunning()) {
+    tracer.stop();
+    LOGI(LOG_SYS, "Trace: stopped");
+    return;
+  }
+  static TraceRecord *buf = NULL;
+  if (!buf) {
+    buf = (TraceRecord *)heap_account.alloc(
+        HEAP_DEBUG, TRACE_RECORDS * sizeof(TraceRecord), MALLOC_CAP_SPIRAM);
+    if (!buf) {
+      LOGE(LOG_SYS, "Trace: buffer allocation failed");
+      return;
+    }
+    tracer.attach(buf, TRACE_RECORDS);
+  }
+  if (tracer.start())
+    LOGI(LOG_SYS, "Trace: running");
+  else
+    LOGW(LOG_SYS, "Trace: still dumping");
+}
+
+// -------------------------------------------------------------------------
+// HEAP ACCOUNTING
+// -------------------------------------------------------------------------
+#define HEAP_INTERNAL_CAPS (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+
+// NimBLE allocates from its own host task after begin() returns, so BLE
+// is booked as the internal heap drop over the next 2s, minus whatever
+// tagged code allocated meanwhile (an estimate).
+static uint32_t ble_free_before;
+static uint32_t ble_tagged_before;
+
+static void job_ble_heap(void *) {
+  int32_t drop = (int32_t)(ble_free_before -
+                           heap_caps_get_free_size(HEAP_INTERNAL_CAPS)) -
+                 (int32_t)(heap_account.tagged(HEAP_INTERNAL) -
+                           ble_tagged_before);
+  if (drop > 0)
+    heap_account.note(HEAP_BLE, HEAP_INTERNAL, drop);
+}
+
+void heap_ble_starting() {
+  ble_free_before = heap_caps_get_free_size(HEAP_INTERNAL_CAPS);
+  ble_tagged_before = heap_account.tagged(HEAP_INTERNAL);
+  sched.once("ble_heap", job_ble_heap, NULL, micros() + 2000000);
+}
+
+// Response bodies on the wire vs parsed: what gzip saves per sync
+static void net_bytes_report() {
+  char line[112];
+  uint32_t saved = net_body_bytes > net_wire_bytes
+                       ? net_body_bytes - net_wire_bytes
+                       : 0;
+  snprintf(line, sizeof(line),
+           "Bodies: %lu (%lu gzip), %lu bytes received, %lu parsed, "
+           "%lu%% saved",
+           (unsigned long)net_bodies, (unsigned long)net_gzip_bodies,
+           (unsigned long)net_wire_bytes, (unsigned long)net_body_bytes,
+           (unsigned long)(net_body_bytes ? (uint64_t)saved * 100 /
+                                                net_body_bytes
+                                          : 0));
+  Serial.println(line);
+}
+
+static void heap_report() {
+  static const uint32_t caps[HEAP_KIND_COUNT] = {HEAP_INTERNAL_CAPS,
+                                                 MALLOC_CAP_SPIRAM};
+  HeapRegion regions[HEAP_KIND_COUNT];
+  for (uint8_t k = 0; k < HEAP_KIND_COUNT; k++) {
+    regions[k].total = heap_caps_get_total_size(caps[k]);
+    regions[k].free = heap_caps_get_free_size(caps[k]);
+    regions[k].largest = heap_caps_get_largest_free_block(caps[k]);
+    regions[k].minFree = heap_caps_get_minimum_free_size(caps[k]);
+  }
+  heap_account.report(Serial, regions);
+  Serial.printf("  net json arena: peak=%u/%u overflows=%lu\n",
+                (unsigned)net_json_alloc.peak(),
+                (unsigned)net_json_alloc.capacity(),
+                (unsigned long)net_json_alloc.overflows());
+}
+
+// Single-letter debug commands over serial
+void handleSerialCommands() {
+  while (Serial.available()) {
+    switch (Serial.read()) {
+    case 'l': { // Input-to-photon latency percentiles, touch filter drag lag
+      LogPrinter out(LOG_UI);
+      latency.report(out);
+      LOGI(LOG_UI, "  touch filter drag lag: %.1fms", touchFilter.lagMs());
+      touchFilter.resetStats();
+      break;
+    }
+    case 'r': // Start / stop session recording
+      session_toggle_record();
+      break;
+    case 'p': // Replay the recorded (or saved) session
+      session_replay();
+      break;
+    case 'd': // Hex dump of the session log
+      session_dump();
+      break;
+    case 'j': // Scheduler job lateness
+      sched.report(Serial);
+      break;
+    case 's': // Longest UI stalls and what caused them
+      stalls.report(Serial);
+      break;
+    case 'f': // Render / flush / idle percentiles per screen
+      frames.report(Serial);
+      break;
+    case 'h': // Heap by subsystem, internal vs PSRAM, fragmentation
+      heap_report();
+      break;
+    case 'w': // Weather cache state, hits / misses and data age
+      for (uint8_t loc = 0; loc < WEATHER_LOCATION_COUNT; loc++)
+        weather_cache[loc].report(Serial, epoch_now(), millis(),
+                                  weather_locations[loc].name);
+      Serial.printf("  last sync: %s, %u locations in %u requests over %u "
+                    "connections, %lu bytes, read+parse %lu us\n",
+                    weather_format, weather_fetched, weather_requests,
+                    weather_connects, (unsigned long)weather_body_bytes,
+                    (unsigned long)weather_read_us);
+      break;
+    case 'n': // WiFi state, radio-on time and time-to-data per sync
+      wifi_mgr.report(Serial, millis());
+      net_bytes_report();
+      break;
+    case 'c': // Clock sync: race winners, time to first valid, drift
+      time_service.report(Serial);
+      time_keeper.report(Serial, epoch_now());
+      break;
+    case 'k': // Per-task CPU share and stack headroom
+      task_monitor.report(Serial);
+      break;
+    case 't': // Start / stop the activity trace
+      trace_toggle();
+      break;
+    case 'T': // Dump the trace (convert with tools/trace2json.py)
+      tracer.beginDump(); // Printed by logTask
+      break;
+    case 'F': // Toggle frame timing collection
+      frames.setEnabled(!frames.isEnabled());
+      Serial.printf("Frame stats %s\n", frames.isEnabled() ? "on" : "off");
+      break;
+    case 'e': // Queue counters
+      Serial.printf("UI bus: posted=%lu depth=%lu max=%lu dropped=%lu\n",
+                    (unsigned long)ui_bus.total(),
+                    (unsigned long)ui_bus.depth(),
+                    (unsigned long)ui_bus.highWater(),
+                    (unsigned long)ui_bus.dropped());
+      Serial.printf("Net state: version=%lu read retries=%lu\n",
+                    (unsigned long)net_state.version(),
+                    (unsigned long)net_state.retries());
+      Serial.printf("Log: max=%lu dropped=%lu\n",
+                    (unsigned long)logger.highWater(),
+                    (unsigned long)logger.dropped());
+      Serial.printf("HID queue: merged=%lu dropped=%lu\n",
+                    (unsigned long)reader.hid().merged(),
+                    (unsigned long)reader.hid().dropped());
+      break;
+    default:
+      break;
+    }
+  }
 }
 // -------------------------------------------------------------------------
 // ENCODER INT
@@ -1150,14 +2600,93 @@ void IRAM_ATTR readEncoder() {
   case 0x0D:
   case 0x04:
     encoderPos++;
+    encoder_input_us = micros();
     break;
   case 0x01:
   case 0x07:
   case 0x0E:
   case 0x08:
     encoderPos--;
+    encoder_input_us = micros();
     break;
+  default:
+    return;
+  }
+
+  BaseType_t woken = pdFALSE;
+  if (ui_task)
+    vTaskNotifyGiveFromISR(ui_task, &woken);
+  if (woken)
+    portYIELD_FROM_ISR();
+}
+
+// -------------------------------------------------------------------------
+// KNOB BUTTON INT
+// -------------------------------------------------------------------------
+
+TimerHandle_t knobTimer;
+// While a session replays, the recorded level stands in for the GPIO. It is
+// still fed from the timer task, so knobButton keeps a single writer.
+volatile bool knob_replaying = false;
+volatile bool knob_replayed_level = false;
+
+// Any edge restarts the debounce window; the level is sampled once it settles
+void IRAM_ATTR onKnobKeyEdge() {
+  if (knob_replaying)
+    return;
+  if (!knob_edge_us) // Bounce after the first edge is not the input
+    knob_edge_us = micros();
+  BaseType_t woken = pdFALSE;
+  xTimerChangePeriodFromISR(
+      knobTimer, pdMS_TO_TICKS(knobButton.cfg.debounceMs), &woken);
+  if (woken)
+    portYIELD_FROM_ISR();
+}
+
+// Runs in the timer service task: feeds the settled level and click/long
+// deadlines to the detector, then re-arms for the next deadline.
+void knobTimerCallback(TimerHandle_t t) {
+  uint32_t now = millis();
+  bool pressed =
+      knob_replaying ? knob_replayed_level : digitalRead(KNOB_KEY) == LOW;
+  // A settled change keeps the micros() of its first raw edge for the
+  // latency probe; a glitch that settles back just drops its stamp
+  static bool level = false;
+  uint32_t edge_us = knob_edge_us;
+  knob_edge_us = 0;
+  if (pressed != level) {
+    level = pressed;
+    if (!edge_us)
+      edge_us = micros();
+    if (pressed)
+      knob_press_us = edge_us;
+    else
+      knob_release_us = edge_us;
   }
+  knobButton.onLevel(now, pressed);
+  knobButton.onTimer(now);
+  if (ui_task)
+    xTaskNotifyGive(ui_task);
+
+  uint32_t due;
+  if (knobButton.nextDeadline(due)) {
+    int32_t wait = (int32_t)(due - now);
+    xTimerChangePeriod(knobTimer, pdMS_TO_TICKS(wait > 0 ? wait : 1), 0);
+  }
+}
+
+// Replay start / end: hand the button to the session or back to the GPIO
+void knob_replay_mode(bool on) {
+  knob_replayed_level = false;
+  knob_replaying = on;
+  xTimerChangePeriod(knobTimer, 1, 0); // Sample the new source next tick
+}
+
+// A replayed level, applied by the timer task on its next tick
+void knob_replay_level(bool pressed) {
+  knob_replayed_level = pressed;
+  knob_edge_us = micros(); // The replayed edge, as the ISR would stamp it
+  xTimerChangePeriod(knobTimer, 1, 0);
 }
 
 void encoder_init() {
@@ -1167,6 +2696,11 @@ void encoder_init() {
 
   attachInterrupt(digitalPinToInterrupt(KNOB_DATA_A), readEncoder, CHANGE);
   attachInterrupt(digitalPinToInterrupt(KNOB_DATA_B), readEncoder, CHANGE);
+
+  knobTimer = xTimerCreate("KnobKey",
+                           pdMS_TO_TICKS(knobButton.cfg.debounceMs),
+                           pdFALSE, NULL, knobTimerCallback);
+  attachInterrupt(digitalPinToInterrupt(KNOB_KEY), onKnobKeyEdge, CHANGE);
 }
 
 // Order of screens
@@ -0,0 +1,69 @@
+#ifndef MOCK_CLIENT_H
+#define MOCK_CLIENT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <zlib.h>
+
+// Stands in for WiFiClient under GzipReader: the body arrives in segments
+// of at most `segment` bytes, available() reports only what has "arrived",
+// read() never blocks and readBytes() takes what it can, like the real
+// client at the end of a body.
+struct MockClient {
+  const std::string &data; // Outlives the client, never copied
+  size_t pos;
+  size_t segment;
+
+  MockClient(const std::string &body, size_t segment)
+      : data(body), pos(0), segment(segment) {}
+
+  int available() {
+    size_t left = data.size() - pos;
+    return (int)(left < segment ? left : segment);
+  }
+
+  int read(uint8_t *buf, size_t n) {
+    size_t k = data.size() - pos;
+    if (k > n)
+      k = n;
+    memcpy(buf, data.data() + pos, k);
+    pos += k;
+    return (int)k;
+  }
+
+  size_t readBytes(char *buf, size_t n) {
+    return (size_t)read((uint8_t *)buf, n);
+  }
+};
+
+static inline bool readFile(const std::string &path, std::string &out) {
+  FILE *f = fopen(path.c_str(), "rb");
+  if (!f)
+    return false;
+  char buf[4096];
+  size_t n;
+  out.clear();
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    out.append(buf, n);
+  fclose(f);
+  return true;
+}
+
+// What a server sends for Content-Encoding: gzip
+static inline std::string gzipBody(const std::string &s) {
+  z_stream z = z_stream();
+  deflateInit2(&z, 9, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+  std::string out(deflateBound(&z, s.size()) + 32, '\0');
+  z.next_in = (Bytef *)s.data();
+  z.avail_in = s.size();
+  z.next_out = (Bytef *)&out[0];
+  z.avail_out = out.size();
+  deflate(&z, Z_FINISH);
+  out.resize(z.total_out);
+  deflateEnd(&z);
+  return out;
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef TOUCH_TRACE_H
+#define TOUCH_TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Touch traces in test/traces/*.trace: one indev read per line,
+//   <ms> 1 <x> <y>   finger down
+//   <ms> 0           released
+// '#' lines are comments; "# expect: a b c" lists the gestures the trace
+// should produce, in order.
+
+struct TouchSample {
+  uint32_t ms;
+  bool pressed;
+  int16_t x, y;
+};
+
+struct TouchTrace {
+  std::vector<TouchSample> samples;
+  std::vector<std::string> expect;
+};
+
+static inline bool loadTouchTrace(const char *path, TouchTrace &t) {
+  FILE *f = fopen(path, "r");
+  if (!f)
+    return false;
+  char line[160];
+  while (fgets(line, sizeof(line), f)) {
+    if (line[0] == '#') {
+      const char *e = strstr(line, "expect:");
+      if (!e)
+        continue;
+      char word[32];
+      int n;
+      for (e += 7; sscanf(e, "%31s%n", word, &n) == 1; e += n)
+        t.expect.push_back(word);
+      continue;
+    }
+    unsigned long ms;
+    int pressed, x = 0, y = 0;
+    int got = sscanf(line, "%lu %d %d %d", &ms, &pressed, &x, &y);
+    if (got < 2)
+      continue;
+    TouchSample s = {(uint32_t)ms, pressed != 0, (int16_t)x, (int16_t)y};
+    t.samples.push_back(s);
+  }
+  fclose(f);
+  return true;
+}
+
+#endif
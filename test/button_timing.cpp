@@ -0,0 +1,138 @@
+// Scripted knob button timings through ButtonEngine.
+// A 1 ms simulation of the sketch's glue: every raw edge restarts the
+// debounce timer (onKnobKeyEdge), and when the timer fires the settled level
+// and deadlines are fed to the engine, then the timer is re-armed for the
+// next deadline (knobTimerCallback). Each script is a list of raw line
+// changes, contact bounce included, and the events it must produce.
+
+#include "ButtonEngine.h"
+#include "check.h"
+#include <string>
+
+struct Edge {
+  uint32_t ms;
+  bool pressed;
+};
+
+struct Script {
+  const char *name;
+  Edge edges[24];
+  const char *expect; // "type@ms ..."
+};
+
+static std::string run(const Script &s, uint32_t &dropped) {
+  static const char *names[] = {"press", "release", "single", "double",
+                                "long"};
+  ButtonEngine b;
+  bool line = false;
+  bool armed = false;
+  uint32_t due = 0;
+  uint32_t end = 0;
+  for (const Edge *e = s.edges; e->ms; e++)
+    end = e->ms;
+  end += 2000; // Let every deadline expire
+
+  std::string out;
+  const Edge *next = s.edges;
+  for (uint32_t t = 0; t <= end; t++) {
+    if (next->ms && next->ms == t) {
+      if (next->pressed != line) {
+        line = next->pressed;
+        armed = true; // Edge restarts the debounce window
+        due = t + b.cfg.debounceMs;
+      }
+      next++;
+    }
+    if (armed && t >= due) {
+      armed = false;
+      b.onLevel(t, line);
+      b.onTimer(t);
+      uint32_t when;
+      if (b.nextDeadline(when)) {
+        int32_t wait = (int32_t)(when - t);
+        armed = true;
+        due = t + (wait > 0 ? wait : 1);
+      }
+    }
+    ButtonEvent ev;
+    while (b.poll(ev)) {
+      char word[32];
+      snprintf(word, sizeof(word), "%s%s@%lu", out.empty() ? "" : " ",
+               names[ev.type], (unsigned long)ev.timestamp);
+      out += word;
+    }
+  }
+  dropped = b.dropped();
+  return out;
+}
+
+// Levels with no timer in between, as when the deadline timer runs late:
+// the gap to the second press alone must decide single versus double
+static void lateTimer() {
+  ButtonEngine b;
+  b.onLevel(100, true);
+  b.onLevel(200, false);
+  b.onLevel(700, true); // 500 ms after the release
+  b.onLevel(800, false);
+  b.onLevel(900, true); // 100 ms after the release
+  b.onLevel(1000, false);
+  static const ButtonEventType want[] = {BTN_PRESS, BTN_RELEASE, BTN_SINGLE,
+                                         BTN_PRESS, BTN_RELEASE, BTN_PRESS,
+                                         BTN_RELEASE, BTN_DOUBLE};
+  static const uint32_t wantMs[] = {100, 200, 500, 700, 800, 900, 1000, 1000};
+  ButtonEvent ev;
+  size_t n = 0;
+  while (b.poll(ev)) {
+    if (n < sizeof(want) / sizeof(want[0])) {
+      CHECK_EQ(ev.type, want[n]);
+      CHECK_EQ(ev.timestamp, wantMs[n]);
+    }
+    n++;
+  }
+  CHECK_EQ(n, sizeof(want) / sizeof(want[0]));
+}
+
+int main() {
+  // Defaults: 20 ms debounce, 300 ms double-click gap, 700 ms long press
+  static const Script scripts[] = {
+      {"click with bounce",
+       {{100, true}, {101, false}, {103, true}, {104, false}, {105, true},
+        {240, false}, {241, true}, {243, false}},
+       "press@125 release@263 single@563"},
+      {"double click",
+       {{100, true}, {102, false}, {103, true}, {200, false}, {350, true},
+        {351, false}, {352, true}, {430, false}},
+       "press@123 release@220 press@372 release@450 double@450"},
+      {"two slow clicks",
+       {{100, true}, {200, false}, {700, true}, {800, false}},
+       "press@120 release@220 single@520 press@720 release@820 single@1120"},
+      {"long press",
+       {{100, true}, {101, false}, {102, true}, {1300, false}},
+       "press@122 long@822 release@1320"},
+      {"glitch shorter than debounce",
+       {{100, true}, {105, false}, {400, true}, {410, false}},
+       ""},
+      {"click then hold",
+       {{100, true}, {180, false}, {300, true}, {1200, false}},
+       "press@120 release@200 press@320 long@1020 release@1220"},
+      {"triple click",
+       {{100, true}, {160, false}, {250, true}, {310, false}, {400, true},
+        {460, false}},
+       "press@120 release@180 press@270 release@330 double@330 press@420 "
+       "release@480 single@780"},
+  };
+
+  lateTimer();
+  for (size_t i = 0; i < sizeof(scripts) / sizeof(scripts[0]); i++) {
+    uint32_t dropped;
+    std::string got = run(scripts[i], dropped);
+    printf("%-30s %s\n", scripts[i].name, got.empty() ? "(none)" : got.c_str());
+    if (got != scripts[i].expect) {
+      fprintf(stderr, "%s: expected \"%s\"\n", scripts[i].name,
+              scripts[i].expect);
+      check_failures++;
+    }
+    CHECK_EQ(dropped, 0);
+  }
+  return check_result("button_timing");
+}
@@ -0,0 +1,37 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+
+// Minimal assertions for the host tests: count failures, keep going, and
+// let main() return check_result() so ctest sees the outcome.
+
+static int check_failures = 0;
+
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      check_failures++;                                                        \
+    }                                                                          \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                                         \
+  do {                                                                         \
+    long long va_ = (long long)(a), vb_ = (long long)(b);                      \
+    if (va_ != vb_) {                                                          \
+      fprintf(stderr, "%s:%d: %s == %s failed (%lld vs %lld)\n", __FILE__,     \
+              __LINE__, #a, #b, va_, vb_);                                     \
+      check_failures++;                                                        \
+    }                                                                          \
+  } while (0)
+
+static inline int check_result(const char *name) {
+  if (check_failures)
+    fprintf(stderr, "%s: %d check(s) failed\n", name, check_failures);
+  else
+    printf("%s: ok\n", name);
+  return check_failures ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,103 @@
+// FrameStats with synthetic timestamps: LVGL passes built from
+// beginPass/beginFlush/endFlush/endPass and the idle time between them,
+// the way loop(), lv_disp_flush() and ui_wait() report them. Checks the
+// per-screen histogram percentiles (bucket upper edges, ">" past the last
+// one), pixel counts, that passes without a flush are not frames, and that
+// screens past MAX_SCREENS share the last slot.
+
+#include "FrameStats.h"
+#include "check.h"
+#include <string>
+#include <vector>
+
+struct Lines {
+  std::vector<std::string> lines;
+  void println(const char *s) { lines.push_back(s); }
+};
+
+static uint32_t t = 0xFFF00000u; // Wraps part way through
+
+// One pass: idle, render around `flushes` panel transfers, render again
+static void pass(FrameStats &f, const void *screen, uint32_t idleUs,
+                 uint32_t renderUs, uint32_t flushUs, uint32_t pixels,
+                 int flushes = 1) {
+  f.addIdle(idleUs);
+  t += idleUs;
+  f.beginPass(t);
+  t += renderUs / 2;
+  for (int i = 0; i < flushes; i++) {
+    f.beginFlush(t);
+    t += flushUs;
+    f.endFlush(t, pixels);
+  }
+  t += renderUs - renderUs / 2;
+  f.endPass(t, screen);
+}
+
+static void expect(const Lines &out, const char *const *want, size_t n) {
+  CHECK_EQ(out.lines.size(), n);
+  for (size_t i = 0; i < n && i < out.lines.size(); i++)
+    if (out.lines[i] != want[i]) {
+      fprintf(stderr, "line %zu: want \"%s\"\n", i, want[i]);
+      check_failures++;
+    }
+}
+
+int main() {
+  static int screens[FrameStats::MAX_SCREENS + 2];
+  FrameStats f;
+  f.nameScreen(&screens[0], "digital");
+  f.nameScreen(&screens[1], "calendar");
+  for (int i = 2; i < FrameStats::MAX_SCREENS - 1; i++)
+    f.nameScreen(&screens[i], "unused");
+  f.nameScreen(&screens[FrameStats::MAX_SCREENS - 1], "other");
+
+  // digital: 90 quick frames, 8 slow ones, 2 that blow past 100 ms; one
+  // of the quick ones flushes twice
+  for (int i = 0; i < 100; i++)
+    pass(f, &screens[0], 5000, i < 90 ? 3000 : i < 98 ? 10000 : 120000, 1500,
+         20500, i == 0 ? 2 : 1);
+
+  // calendar: a pass that draws nothing is no frame, but its idle time
+  // counts toward the next frame's
+  for (int i = 0; i < 10; i++) {
+    if (i == 9)
+      pass(f, &screens[1], 30000, 200, 0, 0, 0);
+    pass(f, &screens[1], i == 9 ? 30000 : 1000, 700, 400, 4000);
+  }
+
+  // The last slot and two screens past it: one bucket
+  for (int i = FrameStats::MAX_SCREENS - 1; i < FrameStats::MAX_SCREENS + 2;
+       i++)
+    pass(f, &screens[i], 2000, 5000, 1000, 1000);
+
+  Lines out;
+  f.report(out);
+  for (size_t i = 0; i < out.lines.size(); i++)
+    printf("%s\n", out.lines[i].c_str());
+  static const char *const want[] = {
+      "Frames (ms, bucket upper bounds):",
+      "  digital    frames=100 px/frame avg=20705 max=41000 flush=13.7 Mpx/s",
+      "    render p50=   4.0 p90=   4.0 p99=>100.0",
+      "    flush  p50=   2.0 p90=   2.0 p99=   2.0", // One 3 ms in 100
+      "    idle   p50=   6.0 p90=   6.0 p99=   6.0",
+      "  calendar   frames=10 px/frame avg=4000 max=4000 flush=10.0 Mpx/s",
+      "    render p50=   1.0 p90=   1.0 p99=   1.0",
+      "    flush  p50=   0.5 p90=   0.5 p99=   0.5",
+      "    idle   p50=   1.0 p90=   1.0 p99= 100.0", // 60 ms over 2 passes
+      "  other      frames=3 px/frame avg=1000 max=1000 flush=1.0 Mpx/s",
+      "    render p50=   6.0 p90=   6.0 p99=   6.0",
+      "    flush  p50=   1.0 p90=   1.0 p99=   1.0",
+      "    idle   p50=   2.0 p90=   2.0 p99=   2.0",
+  };
+  expect(out, want, sizeof(want) / sizeof(want[0]));
+
+  // A report clears; disabled, the hooks record nothing
+  f.setEnabled(false);
+  pass(f, &screens[0], 1000, 1000, 1000, 1000);
+  Lines off;
+  f.report(off);
+  static const char *const wantOff[] = {"Frames: disabled"};
+  expect(off, wantOff, 1);
+  return check_result("frame_stats");
+}
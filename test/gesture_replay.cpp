@@ -0,0 +1,66 @@
+// Replays recorded touch traces through GestureEngine, fed exactly the way
+// lv_indev_read() feeds it, and compares the gestures with the trace's
+// "# expect:" line.
+//   gesture_replay traces/tap.trace [more.trace ...]
+
+#include "GestureEngine.h"
+#include "TouchTrace.h"
+#include "check.h"
+
+static std::string gestureName(const GestureEvent &ev) {
+  static const char *types[] = {"tap", "double-tap", "long-press", "swipe",
+                                "edge-swipe"};
+  static const char *dirs[] = {"", "-left", "-right", "-up", "-down"};
+  return std::string(types[ev.type]) + dirs[ev.dir];
+}
+
+static void replay(const char *path) {
+  TouchTrace t;
+  if (!loadTouchTrace(path, t)) {
+    fprintf(stderr, "%s: can't read\n", path);
+    check_failures++;
+    return;
+  }
+  GestureEngine engine;
+  std::vector<std::string> got;
+  uint32_t downMs = 0;
+  for (size_t i = 0; i < t.samples.size(); i++) {
+    const TouchSample &s = t.samples[i];
+    if (s.pressed && !engine.isTouching())
+      downMs = s.ms;
+    engine.feed(s.ms, s.pressed, s.x, s.y);
+    GestureEvent ev;
+    while (engine.poll(ev)) {
+      got.push_back(gestureName(ev));
+      // Long press is reported while the finger is still down
+      if (ev.type == GESTURE_LONG_PRESS) {
+        CHECK(s.pressed);
+        CHECK(ev.timestamp - downMs >= engine.cfg.longPressMs);
+      }
+      if (ev.type == GESTURE_SWIPE || ev.type == GESTURE_EDGE_SWIPE)
+        CHECK(ev.velocity >= engine.cfg.swipeMinVelocity);
+    }
+  }
+  CHECK_EQ(engine.dropped(), 0);
+
+  std::string want, have;
+  for (size_t i = 0; i < t.expect.size(); i++)
+    want += (i ? " " : "") + t.expect[i];
+  for (size_t i = 0; i < got.size(); i++)
+    have += (i ? " " : "") + got[i];
+  printf("%s: %s\n", path, have.empty() ? "(none)" : have.c_str());
+  if (want != have) {
+    fprintf(stderr, "%s: expected \"%s\"\n", path, want.c_str());
+    check_failures++;
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s trace...\n", argv[0]);
+    return 2;
+  }
+  for (int i = 1; i < argc; i++)
+    replay(argv[i]);
+  return check_result("gesture_replay");
+}
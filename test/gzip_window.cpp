@@ -0,0 +1,118 @@
+// Gzip bodies longer than GzipReader's 32 KB ring, through the reader and
+// test/miniz.h, which like the ROM's tinfl copies back-references out of
+// that ring. A 100 KB stream of forecast-like records (matches near and
+// far) and random blocks repeated at just under the window size (every
+// match reaches back across the ring's wrap) must come out byte for byte,
+// whatever the TCP segment and read sizes. A body cut off mid-stream must
+// fail after serving only what it held.
+
+#include "GzipReader.h"
+#include "MockClient.h"
+#include "check.h"
+
+typedef GzipReader<MockClient> Reader;
+
+static uint8_t window[Reader::WINDOW];
+static tinfl_decompressor inflater;
+
+// Exactly 100 KB of JSON-ish lines: a few values change, the rest repeats
+static std::string records() {
+  std::string s;
+  char line[160];
+  for (unsigned i = 0; s.size() < 100 * 1024; i++) {
+    snprintf(line, sizeof(line),
+             "{\"dt\":%u,\"main\":{\"temp\":%u.%02u,\"humidity\":%u},"
+             "\"weather\":[{\"main\":\"%s\",\"icon\":\"%02ud\"}]},\n",
+             1700000000u + i * 10800u, 18 + i % 13, i * 37 % 100, 40 + i % 50,
+             i % 3 ? "Clouds" : "Rain", 1 + i % 11);
+    s += line;
+  }
+  s.resize(100 * 1024);
+  return s;
+}
+
+// `times` copies of `size` random bytes: incompressible except as a match
+// `size` bytes back
+static std::string repeats(size_t size, int times) {
+  std::string block(size, '\0');
+  uint32_t rng = 2463534242u;
+  for (size_t i = 0; i < size; i++) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    block[i] = (char)rng;
+  }
+  std::string s;
+  for (int i = 0; i < times; i++)
+    s += block;
+  return s;
+}
+
+static void run(const char *name, const std::string &body,
+                const std::string &wire, size_t segment, size_t readSize,
+                bool knownLength) {
+  MockClient client(wire, segment);
+  Reader reader(client, window, &inflater,
+                knownLength ? (int32_t)wire.size() : -1);
+  CHECK(reader.begin(true));
+  std::string out;
+  static char buf[40000];
+  size_t k;
+  while ((k = reader.readBytes(buf, readSize)) > 0)
+    out.append(buf, k);
+  bool same = out == body;
+  if (!same || reader.failed() || !reader.finished()) {
+    fprintf(stderr, "%s segment=%zu read=%zu length=%s: %zu of %zu bytes%s\n",
+            name, segment, readSize, knownLength ? "yes" : "no", out.size(),
+            body.size(), reader.failed() ? ", failed" : "");
+    check_failures++;
+    return;
+  }
+  CHECK_EQ(reader.bodyBytes(), body.size());
+  if (knownLength)
+    CHECK(reader.drain() && client.pos == wire.size());
+}
+
+static void stream(const char *name, const std::string &body) {
+  std::string wire = gzipBody(body);
+  printf("%s: %zu bytes, %zu on the wire\n", name, body.size(), wire.size());
+  static const size_t segments[] = {1, 61, 1460, 1 << 20};
+  static const size_t reads[] = {1, 300, 40000};
+  for (size_t s = 0; s < sizeof(segments) / sizeof(segments[0]); s++)
+    for (size_t r = 0; r < sizeof(reads) / sizeof(reads[0]); r++)
+      for (int known = 0; known < 2; known++)
+        run(name, body, wire, segments[s], reads[r], known);
+}
+
+// Cut at 80%: a prefix of the body, then failed() rather than finished()
+static void truncated(const std::string &body) {
+  std::string wire = gzipBody(body);
+  wire.resize(wire.size() * 4 / 5);
+  MockClient client(wire, 1460);
+  Reader reader(client, window, &inflater, (int32_t)wire.size());
+  CHECK(reader.begin(true));
+  std::string out;
+  static char buf[4096];
+  size_t k;
+  while ((k = reader.readBytes(buf, sizeof(buf))) > 0)
+    out.append(buf, k);
+  CHECK(reader.failed());
+  CHECK(!reader.finished());
+  CHECK(out.size() > Reader::WINDOW && out.size() < body.size());
+  CHECK(!body.compare(0, out.size(), out));
+}
+
+int main() {
+  std::string text = records();
+  CHECK_EQ(text.size(), 100 * 1024);
+  stream("records", text);
+
+  // Matches 32000 bytes back, the longest zlib makes: the wire must hold
+  // one copy of the block and little else
+  std::string far = repeats(32000, 4);
+  CHECK(gzipBody(far).size() < 32000 + 2000);
+  stream("repeats", far);
+
+  truncated(text);
+  return check_result("gzip_window");
+}
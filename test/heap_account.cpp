@@ -0,0 +1,166 @@
+// HeapAccount on a malloc backend that plays both memory kinds: blocks
+// asked for with the PSRAM cap, or too big for internal RAM, count as
+// PSRAM, and realloc() moves a block to whichever kind its new size
+// belongs in, like the ESP-IDF malloc does. Checks the per-tag, per-kind
+// counters through reallocs across kinds, a failed realloc and alloc, a
+// foreign free, and the report lines.
+
+#include "HeapAccount.h"
+#include "check.h"
+#include <map>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static const uint32_t CAP_PSRAM = 1 << 10; // MALLOC_CAP_SPIRAM
+static const size_t INTERNAL_MAX = 4096;   // SPIRAM_MALLOC_ALWAYSINTERNAL
+
+struct Block {
+  size_t size;
+  bool psram;
+};
+
+static std::map<void *, Block> blocks; // Live backend blocks
+static bool failNext;
+
+static void *place(size_t size, bool psram) {
+  if (failNext) {
+    failNext = false;
+    return nullptr;
+  }
+  void *p = malloc(size);
+  Block b = {size, psram};
+  blocks[p] = b;
+  return p;
+}
+
+static void *fakeAlloc(size_t size, uint32_t caps) {
+  return place(size, (caps & CAP_PSRAM) || size > INTERNAL_MAX);
+}
+
+static void fakeFree(void *p) {
+  CHECK(blocks.erase(p) == 1);
+  free(p);
+}
+
+// Always moves, so a kind change is never missed by testing in place
+static void *fakeRealloc(void *p, size_t size) {
+  void *q = place(size, size > INTERNAL_MAX);
+  if (!q)
+    return nullptr;
+  size_t old = blocks[p].size;
+  memcpy(q, p, old < size ? old : size);
+  fakeFree(p);
+  return q;
+}
+
+static bool fakeIsPsram(const void *p) {
+  std::map<void *, Block>::const_iterator it = blocks.find((void *)p);
+  CHECK(it != blocks.end());
+  return it != blocks.end() && it->second.psram;
+}
+
+struct Lines {
+  std::vector<std::string> lines;
+  void println(const char *s) { lines.push_back(s); }
+};
+
+static bool filled(const void *p, size_t n, uint8_t v) {
+  for (size_t i = 0; i < n; i++)
+    if (((const uint8_t *)p)[i] != v)
+      return false;
+  return true;
+}
+
+int main() {
+  HeapAccount heap({fakeAlloc, fakeRealloc, fakeFree, fakeIsPsram});
+
+  void *e = heap.alloc(HEAP_ENGINES, 100);
+  void *l = heap.alloc(HEAP_LVGL, 100);
+  void *d = heap.alloc(HEAP_DISPLAY, 2000, CAP_PSRAM);
+  CHECK_EQ(heap.live(HEAP_ENGINES, HEAP_INTERNAL), 100);
+  CHECK_EQ(heap.live(HEAP_DISPLAY, HEAP_PSRAM), 2000);
+  memset(l, 0x5A, 100);
+
+  // Grows out of internal RAM: the tag stays, the bytes move kind
+  l = heap.realloc(l, 6000, HEAP_NET);
+  CHECK(l && filled(l, 100, 0x5A));
+  CHECK_EQ(heap.live(HEAP_LVGL, HEAP_INTERNAL), 0);
+  CHECK_EQ(heap.live(HEAP_LVGL, HEAP_PSRAM), 6000);
+  CHECK_EQ(heap.live(HEAP_NET, HEAP_INTERNAL), 0);
+  CHECK_EQ(heap.live(HEAP_NET, HEAP_PSRAM), 0);
+
+  // Same kind: by the difference; then back to internal
+  l = heap.realloc(l, 7000, HEAP_LVGL);
+  CHECK_EQ(heap.live(HEAP_LVGL, HEAP_PSRAM), 7000);
+  l = heap.realloc(l, 300, HEAP_LVGL);
+  CHECK(l && filled(l, 100, 0x5A));
+  CHECK_EQ(heap.live(HEAP_LVGL, HEAP_PSRAM), 0);
+  CHECK_EQ(heap.peak(HEAP_LVGL, HEAP_PSRAM), 7000);
+  CHECK_EQ(heap.live(HEAP_LVGL, HEAP_INTERNAL), 300);
+  CHECK_EQ(heap.peak(HEAP_LVGL, HEAP_INTERNAL), 300);
+
+  // A failed realloc leaves the block and its counters alone
+  failNext = true;
+  CHECK(heap.realloc(l, 9000, HEAP_LVGL) == nullptr);
+  CHECK(filled(l, 100, 0x5A));
+  CHECK_EQ(heap.live(HEAP_LVGL, HEAP_INTERNAL), 300);
+  CHECK_EQ(heap.peak(HEAP_LVGL, HEAP_PSRAM), 7000);
+  failNext = true;
+  CHECK(heap.alloc(HEAP_NET, 10) == nullptr);
+
+  void *n = heap.realloc(nullptr, 50, HEAP_NET); // Takes the new tag
+  CHECK_EQ(heap.live(HEAP_NET, HEAP_INTERNAL), 50);
+
+  uint64_t foreign[4] = {0}; // No header: counted, not passed on
+  heap.free(&foreign[1]);
+  heap.note(HEAP_BLE, HEAP_INTERNAL, 1234);
+  CHECK_EQ(heap.tagged(HEAP_INTERNAL), 300 + 100 + 50 + 1234);
+  CHECK_EQ(heap.tagged(HEAP_PSRAM), 2000);
+
+  const HeapRegion regions[HEAP_KIND_COUNT] = {
+      {300000, 200000, 150000, 180000}, {8388608, 8000000, 7900000, 7990000}};
+  Lines out;
+  heap.report(out, regions);
+  for (size_t i = 0; i < out.lines.size(); i++)
+    printf("%s\n", out.lines[i].c_str());
+  static const char *const want[] = {
+      "Heap by subsystem (bytes):",
+      "  internal lvgl    live=     300 peak=     300 allocs=      2 "
+      "frees=      1",
+      "  internal engines live=     100 peak=     100 allocs=      1 "
+      "frees=      0",
+      "  internal net     live=      50 peak=      50 allocs=      1 "
+      "frees=      0",
+      "  internal ble     live=    1234 peak=    1234 allocs=      0 "
+      "frees=      0",
+      "  internal used=100000/300000 untagged=98316 min_free=180000 "
+      "largest=150000 frag=25%",
+      "  psram    lvgl    live=       0 peak=    7000 allocs=      1 "
+      "frees=      1",
+      "  psram    display live=    2000 peak=    2000 allocs=      1 "
+      "frees=      0",
+      "  psram    used=388608/8388608 untagged=386608 min_free=7990000 "
+      "largest=7900000 frag=1%",
+      "  failed allocs=2 foreign frees=1",
+  };
+  const size_t lines = sizeof(want) / sizeof(want[0]);
+  CHECK_EQ(out.lines.size(), lines);
+  for (size_t i = 0; i < lines && i < out.lines.size(); i++)
+    if (out.lines[i] != want[i]) {
+      fprintf(stderr, "line %zu: want \"%s\"\n", i, want[i]);
+      check_failures++;
+    }
+
+  // Everything goes back to the backend; only the noted bytes stay
+  heap.free(e);
+  heap.free(l);
+  heap.free(d);
+  heap.free(n);
+  CHECK(blocks.empty());
+  CHECK_EQ(heap.tagged(HEAP_INTERNAL), 1234);
+  CHECK_EQ(heap.tagged(HEAP_PSRAM), 0);
+  CHECK_EQ(heap.peak(HEAP_DISPLAY, HEAP_PSRAM), 2000);
+  return check_result("heap_account");
+}
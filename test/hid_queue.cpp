@@ -0,0 +1,139 @@
+// HidActionQueue with a mock mouse, driven the way ReaderEngine::update()
+// drives BleMouse: reports go out in order and not before their time, a
+// full queue folds scrolls together instead of losing them silently, and a
+// disconnect drops whatever was pending.
+
+#include "HidActionQueue.h"
+#include "check.h"
+#include <vector>
+
+struct Report {
+  uint32_t ms;
+  int8_t x, y, wheel;
+};
+
+struct MockMouse {
+  bool connected;
+  uint32_t now;
+  std::vector<Report> sent;
+  MockMouse() : connected(true), now(0) {}
+  void move(int8_t x, int8_t y, int8_t wheel) {
+    CHECK(connected);
+    Report r = {now, x, y, wheel};
+    sent.push_back(r);
+  }
+};
+
+typedef HidActionQueue<MockMouse> Queue;
+
+// One reader tick: advance while connected, forget everything otherwise
+static void tick(Queue &q, MockMouse &m, uint32_t now) {
+  m.now = now;
+  if (m.connected)
+    q.advance(now, m);
+  else
+    q.clear();
+}
+
+static void run(Queue &q, MockMouse &m, uint32_t from, uint32_t to) {
+  for (uint32_t t = from; t != to; t++)
+    tick(q, m, t);
+}
+
+static void expect(const MockMouse &m, size_t i, uint32_t ms, int x, int y,
+                   int wheel) {
+  if (i >= m.sent.size()) {
+    fprintf(stderr, "report %zu missing\n", i);
+    check_failures++;
+    return;
+  }
+  CHECK_EQ(m.sent[i].ms, ms);
+  CHECK_EQ(m.sent[i].x, x);
+  CHECK_EQ(m.sent[i].y, y);
+  CHECK_EQ(m.sent[i].wheel, wheel);
+}
+
+// The cursor kick and scroll shake, queued in one go like
+// performCursorKick(), then a scroll that must wait its turn
+static void pacing() {
+  Queue q;
+  MockMouse m;
+  const uint32_t t0 = 0xFFFFFFC0u; // Wraps mid-sequence
+  CHECK(q.then(t0, 0, 100, 100));
+  CHECK(q.then(t0, 50, 100, 100));
+  CHECK(q.then(t0, 50, 0, 0, -2));
+  CHECK(q.then(t0, 50, 0, 0, 2));
+  CHECK(q.then(t0 + 10, 0, 0, 0, 5)); // Lands after the shake
+  run(q, m, t0, t0 + 300);
+  CHECK_EQ(m.sent.size(), 5);
+  expect(m, 0, t0, 100, 100, 0);
+  expect(m, 1, t0 + 50, 100, 100, 0);
+  expect(m, 2, t0 + 100, 0, 0, -2);
+  expect(m, 3, t0 + 150, 0, 0, 2);
+  expect(m, 4, t0 + 150, 0, 0, 5);
+  CHECK(q.idle());
+
+  // Idle again: a new report is timed from now, not the old sequence
+  CHECK(q.then(t0 + 300, 20, -100, -100));
+  run(q, m, t0 + 300, t0 + 400);
+  expect(m, 5, t0 + 320, -100, -100, 0);
+  CHECK_EQ(q.merged(), 0);
+  CHECK_EQ(q.dropped(), 0);
+}
+
+// Host gone mid-sequence: the rest is discarded, nothing is sent while
+// disconnected, and the next connection starts from an empty queue
+static void disconnect() {
+  Queue q;
+  MockMouse m;
+  CHECK(q.then(1000, 0, 100, 100));
+  CHECK(q.then(1000, 50, 100, 100));
+  CHECK(q.then(1000, 50, -100, -100));
+  run(q, m, 1000, 1030);
+  CHECK_EQ(m.sent.size(), 1);
+  m.connected = false;
+  run(q, m, 1030, 1200);
+  CHECK(q.idle());
+  m.connected = true;
+  CHECK(q.then(1200, 0, 0, 0, 3));
+  run(q, m, 1200, 1300);
+  CHECK_EQ(m.sent.size(), 2);
+  expect(m, 1, 1200, 0, 0, 3);
+}
+
+// Sixteen slots: a long move sequence fills them, then 15 ms scroll sends
+// keep coming. They fold into the last scroll-only report up to +/-127;
+// a move doesn't fit anywhere.
+static void full() {
+  Queue q;
+  MockMouse m;
+  for (int i = 0; i < 15; i++)
+    CHECK(q.then(0, 10, 1, 1));
+  CHECK(q.then(0, 0, 0, 0, 40)); // Slot 16
+  CHECK(q.then(0, 0, 0, 0, 40)); // 80
+  CHECK(q.then(0, 0, 0, 0, 40)); // 120
+  CHECK(!q.then(0, 0, 0, 0, 40)); // 127, 33 lost
+  CHECK(!q.then(0, 0, 1, 0));     // No room for a move
+  CHECK(!q.then(0, 10, 0, 0, 5)); // Nor for a later scroll
+  CHECK_EQ(q.merged(), 3);
+  CHECK_EQ(q.dropped(), 3);
+  run(q, m, 0, 200);
+  CHECK_EQ(m.sent.size(), 16);
+  expect(m, 15, 150, 0, 0, 127);
+  int moved = 0;
+  for (size_t i = 0; i < 15 && i < m.sent.size(); i++)
+    moved += m.sent[i].x;
+  CHECK_EQ(moved, 15);
+
+  // Room again: reports queue normally
+  CHECK(q.then(200, 0, 0, 0, -7));
+  run(q, m, 200, 201);
+  expect(m, 16, 200, 0, 0, -7);
+}
+
+int main() {
+  pacing();
+  disconnect();
+  full();
+  return check_result("hid_queue");
+}
@@ -0,0 +1,83 @@
+// Input-to-photon bookkeeping of LatencyProbe, replayed with synthetic
+// microsecond stamps: inputs armed against a widget area, flush rectangles
+// fed the way lv_disp_flush() reports them, then the report() percentiles
+// read back through a capturing printer.
+
+#include "LatencyProbe.h"
+#include "check.h"
+#include <string>
+#include <vector>
+
+struct Lines {
+  std::vector<std::string> lines;
+  void println(const char *s) { lines.push_back(s); }
+  bool has(const char *s) const {
+    for (size_t i = 0; i < lines.size(); i++)
+      if (lines[i] == s)
+        return true;
+    fprintf(stderr, "missing report line \"%s\"\n", s);
+    return false;
+  }
+};
+
+// Two screens; the widget sits in the top-left corner of the first
+static const int A = 1, B = 2;
+static const void *const digital = &A;
+static const void *const calendar = &B;
+
+int main() {
+  LatencyProbe probe;
+  probe.nameScreen(digital, "digital");
+  probe.nameScreen(calendar, "calendar");
+
+  // Latencies of 1..100 ms, each closed by the first flush that counts
+  uint32_t t = 1000000;
+  for (uint32_t i = 1; i <= 100; i++) {
+    probe.arm(INPUT_ENCODER, t, digital, 0, 0, 99, 99);
+    // A burst: later ticks before the redraw are not measured
+    probe.arm(INPUT_ENCODER, t + 300, digital, 0, 0, 99, 99);
+    // Another screen drawing over the same pixels (the old screen before a
+    // load animation starts) and a rectangle that misses the widget
+    probe.onFlush(0, 0, 409, 501, t + 100, calendar);
+    probe.onFlush(100, 100, 409, 501, t + 200, digital);
+    probe.onFlush(90, 90, 200, 200, t + i * 1000, digital);
+    t += 200000;
+  }
+
+  // A double click that redraws the calendar 12.3 ms later
+  probe.arm(INPUT_BUTTON, t, calendar, 10, 10, 400, 400);
+  probe.onFlush(0, 0, 409, 501, t + 12300, calendar);
+  t += 200000;
+
+  // A touch that never redraws its area times out after a second; a zero
+  // stamp (no input seen) arms nothing
+  probe.arm(INPUT_TOUCH, t, digital, 300, 300, 340, 340);
+  probe.onFlush(0, 0, 9, 9, t + 500000, digital);
+  probe.onFlush(0, 0, 9, 9, t + LatencyProbe::TIMEOUT_US + 1, digital);
+  probe.arm(INPUT_TOUCH, 0, digital, 0, 0, 409, 501);
+  probe.onFlush(0, 0, 409, 501, t + 2000000, digital);
+
+  // Only the last SAMPLES per bucket are kept: 200 at 2 ms then 128 at 3 ms
+  // leave nothing but 3 ms. More screens than slots share the last one.
+  static int extra[LatencyProbe::MAX_SCREENS + 2];
+  for (size_t s = 0; s < sizeof(extra) / sizeof(extra[0]); s++)
+    probe.nameScreen(&extra[s], "extra");
+  const void *overflow = &extra[LatencyProbe::MAX_SCREENS + 1];
+  for (int i = 0; i < 200 + LatencyProbe::SAMPLES; i++) {
+    t += 100000;
+    probe.arm(INPUT_TOUCH, t, overflow, 0, 0, 9, 9);
+    probe.onFlush(0, 0, 9, 9, t + (i < 200 ? 2000 : 3000), overflow);
+  }
+
+  Lines out;
+  probe.report(out);
+  for (size_t i = 0; i < out.lines.size(); i++)
+    printf("%s\n", out.lines[i].c_str());
+  CHECK(out.has("  encoder digital    n=100 p50= 50.0 p95= 95.0 p99= 99.0"));
+  CHECK(out.has("  button  calendar   n=  1 p50= 12.3 p95= 12.3 p99= 12.3"));
+  CHECK(out.has("  touch   extra      n=128 p50=  3.0 p95=  3.0 p99=  3.0"));
+  CHECK(out.has("  no-redraw timeouts: 1"));
+  // encoder, button, overflow touch, header and timeouts: nothing else
+  CHECK_EQ(out.lines.size(), 5);
+  return check_result("latency_replay");
+}
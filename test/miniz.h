@@ -0,0 +1,352 @@
+#ifndef TEST_MINIZ_H
+#define TEST_MINIZ_H
+
+// The part of miniz's tinfl API that GzipReader uses, so host tests run the
+// firmware's gzip path without the ROM copy. A small raw-deflate inflater
+// written to tinfl's contract rather than miniz itself: it resumes at any
+// input or output boundary, keeps no history of its own and reads
+// back-references out of the caller's output buffer. Unless
+// TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF is set, that buffer is a ring of
+// (out_next - out_start) + *out_size bytes, a power of two, and a match at
+// distance d is copied from out_start[(pos - d) & mask], wrapping past the
+// start the way the ROM's tinfl does. No zlib header or Adler-32.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define TINFL_LZ_DICT_SIZE 32768
+#define TINFL_FLAG_HAS_MORE_INPUT 2
+#define TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF 4
+
+typedef enum {
+  TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS = -4,
+  TINFL_STATUS_BAD_PARAM = -3,
+  TINFL_STATUS_FAILED = -1,
+  TINFL_STATUS_DONE = 0,
+  TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+  TINFL_STATUS_HAS_MORE_OUTPUT = 2
+} tinfl_status;
+
+// Canonical Huffman code: codes per length, symbols in code order
+struct tinfl_huff {
+  uint16_t count[16];
+  uint16_t symbol[288];
+};
+
+enum {
+  TINFL_ST_BLOCK,  // Block header
+  TINFL_ST_STORED, // LEN / NLEN of a stored block
+  TINFL_ST_COPY,   // Stored bytes
+  TINFL_ST_COUNTS, // HLIT, HDIST, HCLEN
+  TINFL_ST_CLENS,  // Code length code lengths
+  TINFL_ST_LENS,   // Literal/length and distance code lengths
+  TINFL_ST_SYM,    // Literal/length symbols
+  TINFL_ST_DIST,   // Distance of the match just read
+  TINFL_ST_MATCH,  // Bytes of that match
+  TINFL_ST_DONE
+};
+
+// Fixed size, no heap: the caller allocates it once, like the ROM's
+struct tinfl_decompressor {
+  uint8_t state;
+  bool last;      // BFINAL of the current block
+  uint64_t bits;  // Input bits not yet used, LSB first
+  uint32_t nbits;
+  uint32_t left;  // Stored bytes or match bytes still to copy
+  uint32_t dist;
+  uint32_t total; // Bytes out since tinfl_init(): how far back is valid
+  uint16_t nlen, ndist, ncode, index;
+  uint8_t lengths[19 + 286 + 30]; // Code length code, then the rest
+  tinfl_huff lencode, distcode;
+};
+
+static inline void tinfl_init(tinfl_decompressor *d) {
+  d->state = TINFL_ST_BLOCK;
+  d->bits = 0;
+  d->nbits = 0;
+  d->total = 0;
+}
+
+// Code table from code lengths; false if over-subscribed. Incomplete codes
+// are allowed (one distance code is legal), unused codes fail in decode.
+static inline bool tinfl_build(tinfl_huff *h, const uint8_t *length,
+                               int n) {
+  memset(h->count, 0, sizeof(h->count));
+  for (int s = 0; s < n; s++)
+    h->count[length[s]]++;
+  int left = 1;
+  for (int len = 1; len < 16; len++) {
+    left = (left << 1) - h->count[len];
+    if (left < 0)
+      return false;
+  }
+  uint16_t offs[16];
+  offs[1] = 0;
+  for (int len = 1; len < 15; len++)
+    offs[len + 1] = offs[len] + h->count[len];
+  for (int s = 0; s < n; s++)
+    if (length[s])
+      h->symbol[offs[length[s]]++] = s;
+  return true;
+}
+
+// Next symbol without using its bits: 1 and its code length, 0 if more
+// input is needed, -1 for a code that isn't in the table
+static inline int tinfl_peek(const tinfl_decompressor *d, const tinfl_huff *h,
+                             int *sym, uint32_t *len) {
+  int code = 0, first = 0, index = 0;
+  for (uint32_t l = 1; l < 16; l++) {
+    if (l > d->nbits)
+      return 0;
+    code |= (int)(d->bits >> (l - 1)) & 1;
+    int count = h->count[l];
+    if (code - first < count) {
+      *sym = h->symbol[index + code - first];
+      *len = l;
+      return 1;
+    }
+    index += count;
+    first = (first + count) << 1;
+    code <<= 1;
+  }
+  return -1;
+}
+
+static inline uint32_t tinfl_take(tinfl_decompressor *d, uint32_t n) {
+  uint32_t v = (uint32_t)(d->bits & ((1ull << n) - 1));
+  d->bits >>= n;
+  d->nbits -= n;
+  return v;
+}
+
+static inline tinfl_status tinfl_decompress(tinfl_decompressor *d,
+                                            const uint8_t *in, size_t *inSize,
+                                            uint8_t *outStart, uint8_t *outNext,
+                                            size_t *outSize, uint32_t flags) {
+  static const uint8_t order[19] = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                    11, 4,  12, 3, 13, 2, 14, 1, 15};
+  static const uint16_t lbase[29] = {3,  4,  5,  6,  7,  8,  9,  10,  11, 13,
+                                     15, 17, 19, 23, 27, 31, 35, 43,  51, 59,
+                                     67, 83, 99, 115, 131, 163, 195, 227, 258};
+  static const uint8_t lext[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                   2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+  static const uint16_t dbase[30] = {
+      1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,
+      97,  129, 193, 257, 385, 513,  769,  1025, 1537, 2049, 3073, 4097, 6145,
+      8193, 12289, 16385, 24577};
+  static const uint8_t dext[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,
+                                   4, 4, 5, 5, 6, 6, 7, 7,  8,  8,
+                                   9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+  const size_t inEnd = *inSize, outEnd = *outSize;
+  size_t ip = 0, op = 0;
+  const size_t pos0 = (size_t)(outNext - outStart);
+  size_t mask = (size_t)-1;
+  if (!(flags & TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF)) {
+    mask = pos0 + outEnd - 1;
+    if (outNext < outStart || ((mask + 1) & mask)) {
+      *inSize = *outSize = 0;
+      return TINFL_STATUS_BAD_PARAM;
+    }
+  }
+  tinfl_status st = TINFL_STATUS_DONE;
+
+// Pulls bytes until n bits are buffered, else stops for more input
+#define TINFL_NEED(n)                                                          \
+  while (d->nbits < (n)) {                                                     \
+    if (ip == inEnd)                                                           \
+      goto starved;                                                            \
+    d->bits |= (uint64_t)in[ip++] << d->nbits;                                 \
+    d->nbits += 8;                                                             \
+  }
+// Next symbol of a code, with `extra` bits after it; both or neither used.
+// Stops for output space, leaving the bits, when `hold` is true for it.
+#define TINFL_SYMBOL(h, sym, extraOf, hold)                                    \
+  for (;;) {                                                                   \
+    uint32_t codeLen;                                                          \
+    int r = tinfl_peek(d, h, &sym, &codeLen);                                  \
+    if (r < 0)                                                                 \
+      goto failed;                                                             \
+    if (r > 0 && (hold))                                                       \
+      goto full;                                                               \
+    if (r > 0 && d->nbits >= codeLen + (extraOf)) {                            \
+      tinfl_take(d, codeLen);                                                  \
+      break;                                                                   \
+    }                                                                          \
+    if (ip == inEnd)                                                           \
+      goto starved;                                                            \
+    d->bits |= (uint64_t)in[ip++] << d->nbits;                                 \
+    d->nbits += 8;                                                             \
+  }
+
+  for (;;) {
+    switch (d->state) {
+    case TINFL_ST_BLOCK: {
+      TINFL_NEED(3);
+      d->last = tinfl_take(d, 1);
+      uint32_t type = tinfl_take(d, 2);
+      if (type == 0) {
+        tinfl_take(d, d->nbits & 7); // To a byte boundary
+        d->state = TINFL_ST_STORED;
+      } else if (type == 1) {
+        for (int s = 0; s < 288; s++)
+          d->lengths[s] = s < 144 ? 8 : s < 256 ? 9 : s < 280 ? 7 : 8;
+        tinfl_build(&d->lencode, d->lengths, 288);
+        for (int s = 0; s < 30; s++)
+          d->lengths[s] = 5;
+        tinfl_build(&d->distcode, d->lengths, 30);
+        d->state = TINFL_ST_SYM;
+      } else if (type == 2) {
+        d->state = TINFL_ST_COUNTS;
+      } else {
+        goto failed;
+      }
+      break;
+    }
+    case TINFL_ST_STORED: {
+      TINFL_NEED(32);
+      uint32_t len = tinfl_take(d, 16);
+      if (tinfl_take(d, 16) != (~len & 0xFFFF))
+        goto failed;
+      d->left = len;
+      d->state = TINFL_ST_COPY;
+      break;
+    }
+    case TINFL_ST_COPY:
+      while (d->left) {
+        if (op == outEnd)
+          goto full;
+        TINFL_NEED(8);
+        outNext[op++] = (uint8_t)tinfl_take(d, 8);
+        d->total++;
+        d->left--;
+      }
+      d->state = d->last ? TINFL_ST_DONE : TINFL_ST_BLOCK;
+      break;
+    case TINFL_ST_COUNTS:
+      TINFL_NEED(14);
+      d->nlen = tinfl_take(d, 5) + 257;
+      d->ndist = tinfl_take(d, 5) + 1;
+      d->ncode = tinfl_take(d, 4) + 4;
+      if (d->nlen > 286 || d->ndist > 30)
+        goto failed;
+      memset(d->lengths, 0, 19);
+      d->index = 0;
+      d->state = TINFL_ST_CLENS;
+      break;
+    case TINFL_ST_CLENS:
+      while (d->index < d->ncode) {
+        TINFL_NEED(3);
+        d->lengths[order[d->index++]] = tinfl_take(d, 3);
+      }
+      if (!tinfl_build(&d->lencode, d->lengths, 19)) // Code length code
+        goto failed;
+      d->index = 0;
+      d->state = TINFL_ST_LENS;
+      break;
+    case TINFL_ST_LENS: {
+      uint8_t *lens = d->lengths + 19; // Past the code length code's
+      const uint32_t n = d->nlen + d->ndist;
+      while (d->index < n) {
+        int sym = 0;
+        TINFL_SYMBOL(&d->lencode, sym,
+                     sym < 16 ? 0 : sym == 16 ? 2 : sym == 17 ? 3 : 7, false);
+        if (sym < 16) {
+          lens[d->index++] = sym;
+          continue;
+        }
+        uint8_t fill = 0;
+        uint32_t rep;
+        if (sym == 16) {
+          if (!d->index)
+            goto failed;
+          fill = lens[d->index - 1];
+          rep = 3 + tinfl_take(d, 2);
+        } else if (sym == 17) {
+          rep = 3 + tinfl_take(d, 3);
+        } else {
+          rep = 11 + tinfl_take(d, 7);
+        }
+        if (d->index + rep > n)
+          goto failed;
+        while (rep--)
+          lens[d->index++] = fill;
+      }
+      if (!lens[256] || !tinfl_build(&d->lencode, lens, d->nlen) ||
+          !tinfl_build(&d->distcode, lens + d->nlen, d->ndist))
+        goto failed;
+      d->state = TINFL_ST_SYM;
+      break;
+    }
+    case TINFL_ST_SYM:
+      for (;;) {
+        int sym = 0;
+        TINFL_SYMBOL(&d->lencode, sym,
+                     sym > 256 && sym < 286 ? lext[sym - 257] : 0,
+                     sym < 256 && op == outEnd);
+        if (sym < 256) {
+          outNext[op++] = (uint8_t)sym;
+          d->total++;
+          continue;
+        }
+        if (sym == 256) {
+          d->state = d->last ? TINFL_ST_DONE : TINFL_ST_BLOCK;
+          break;
+        }
+        if (sym > 285)
+          goto failed;
+        d->left = lbase[sym - 257] + tinfl_take(d, lext[sym - 257]);
+        d->state = TINFL_ST_DIST;
+        break;
+      }
+      break;
+    case TINFL_ST_DIST: {
+      int sym = 0;
+      TINFL_SYMBOL(&d->distcode, sym, sym < 30 ? dext[sym] : 0, false);
+      if (sym > 29)
+        goto failed;
+      d->dist = dbase[sym] + tinfl_take(d, dext[sym]);
+      if (d->dist > d->total || d->dist > TINFL_LZ_DICT_SIZE ||
+          ((flags & TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF) &&
+           d->dist > pos0 + op))
+        goto failed;
+      d->state = TINFL_ST_MATCH;
+      break;
+    }
+    case TINFL_ST_MATCH:
+      while (d->left) {
+        if (op == outEnd)
+          goto full;
+        size_t pos = pos0 + op;
+        outNext[op++] = outStart[(pos - d->dist) & mask];
+        d->total++;
+        d->left--;
+      }
+      d->state = TINFL_ST_SYM;
+      break;
+    case TINFL_ST_DONE:
+      st = TINFL_STATUS_DONE;
+      goto out;
+    }
+  }
+
+starved:
+  st = (flags & TINFL_FLAG_HAS_MORE_INPUT)
+           ? TINFL_STATUS_NEEDS_MORE_INPUT
+           : TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS;
+  goto out;
+full:
+  st = TINFL_STATUS_HAS_MORE_OUTPUT;
+  goto out;
+failed:
+  st = TINFL_STATUS_FAILED;
+out:
+  *inSize = ip;
+  *outSize = op;
+  return st;
+#undef TINFL_NEED
+#undef TINFL_SYMBOL
+}
+
+#endif
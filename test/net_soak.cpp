@@ -0,0 +1,171 @@
+// 10,000 simulated fetch cycles through the network task's parse path, with
+// the heap watched. Each cycle parses what one network_sync() round reads:
+// the time body (filtered unixtime/datetime, as syncTimeViaHTTP does), an
+// OpenWeather body per location (plain and gzip) and a MsgPack weather
+// bundle, every document in the one JsonArena<4096>, every result in fixed
+// storage. After a warm-up cycle (static filters, stdio buffers) the test
+// code must make no malloc/realloc/calloc call at all, and glibc's count of
+// bytes in use must not move.
+//   net_soak test/payloads
+
+#include "GzipReader.h"
+#include "JsonArena.h"
+#include "MockClient.h"
+#include "WeatherBundle.h"
+#include "WeatherParser.h"
+#include "check.h"
+#include <malloc.h>
+
+// Linked with --wrap, so every heap call made from this program's code
+// (ArduinoJson's default allocator included) lands here first
+extern "C" {
+void *__real_malloc(size_t);
+void *__real_calloc(size_t, size_t);
+void *__real_realloc(void *, size_t);
+static uint32_t heap_calls;
+void *__wrap_malloc(size_t n) {
+  heap_calls++;
+  return __real_malloc(n);
+}
+void *__wrap_calloc(size_t n, size_t size) {
+  heap_calls++;
+  return __real_calloc(n, size);
+}
+void *__wrap_realloc(void *p, size_t n) {
+  heap_calls++;
+  return __real_realloc(p, n);
+}
+}
+
+static const uint32_t CYCLES = 10000;
+
+static JsonArena<4096> arena; // NET_JSON_ARENA_BYTES
+static uint8_t window[GzipReader<MockClient>::WINDOW];
+static tinfl_decompressor inflater;
+
+struct Body {
+  std::string wire;
+  bool gzip;
+};
+
+// syncTimeViaHTTP() without the HTTP: unixtime plus the datetime fraction
+static int64_t parseTime(GzipReader<MockClient> &body) {
+  static JsonDocument filter; // Built once, like the sketch's
+  if (filter.isNull()) {
+    filter["unixtime"] = true;
+    filter["datetime"] = true;
+  }
+  JsonDocument doc(&arena);
+  DeserializationError error = deserializeJson(
+      doc, body, DeserializationOption::Filter(filter.as<JsonVariantConst>()));
+  if (error)
+    return 0;
+  int64_t unixtime = doc["unixtime"] | (int64_t)0;
+  int32_t frac = 0;
+  const char *dt = doc["datetime"];
+  const char *dot = dt ? strchr(dt, '.') : NULL;
+  if (dot) {
+    int32_t scale = 100000;
+    for (const char *c = dot + 1; *c >= '0' && *c <= '9' && scale;
+         c++, scale /= 10)
+      frac += (*c - '0') * scale;
+  }
+  return unixtime * 1000000 + frac;
+}
+
+// One fetch cycle; false if any result is off
+static bool cycle(const Body &time, const Body *weather, size_t nWeather,
+                  const Body &bundle, uint32_t n) {
+  bool ok = true;
+  size_t segment = 1 + n % 1460; // A different TCP split every cycle
+  {
+    MockClient c(time.wire, segment);
+    GzipReader<MockClient> body(c, window, &inflater, time.wire.size());
+    ok &= body.begin(time.gzip);
+    ok &= parseTime(body) == 1792317600123456LL;
+    ok &= body.drain();
+  }
+  for (size_t i = 0; i < nWeather; i++) {
+    MockClient c(weather[i].wire, segment);
+    GzipReader<MockClient> body(c, window, &inflater,
+                                weather[i].wire.size());
+    ok &= body.begin(weather[i].gzip);
+    WeatherData w;
+    ok &= !parseWeather(body, w, &arena) && w.valid;
+    ok &= body.drain();
+  }
+  {
+    MockClient c(bundle.wire, segment);
+    GzipReader<MockClient> body(c, window, &inflater, bundle.wire.size());
+    ok &= body.begin(bundle.gzip);
+    for (int loc = 0; loc < 2; loc++) {
+      WeatherData w;
+      ok &= !parseWeatherBundle(body, w, &arena) && w.valid && w.days == 6;
+    }
+    ok &= body.drain();
+  }
+  return ok && arena.used() == 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s payload-dir\n", argv[0]);
+    return 2;
+  }
+  // Bodies are built up front: gzip and MsgPack encoding use the heap
+  std::string json;
+  Body time;
+  time.wire = gzipBody("{\"abbreviation\":\"IST\",\"datetime\":"
+                       "\"2026-10-18T10:00:00.123456+05:30\",\"day_of_week\":"
+                       "0,\"timezone\":\"Asia/Kolkata\",\"unixtime\":"
+                       "1792317600,\"utc_offset\":\"+05:30\"}");
+  time.gzip = true;
+  Body weather[2];
+  CHECK(readFile(std::string(argv[1]) + "/weather_bengaluru.json", json));
+  weather[0].wire = json;
+  weather[0].gzip = false;
+  CHECK(readFile(std::string(argv[1]) + "/weather_mumbai_rain.json", json));
+  weather[1].wire = gzipBody(json);
+  weather[1].gzip = true;
+  Body bundle;
+  {
+    JsonDocument doc;
+    JsonArray b = doc.to<JsonArray>();
+    b.add(WEATHER_BUNDLE_VERSION);
+    b.add(1792317600);
+    b.add(243);
+    b.add("Clouds");
+    JsonArray days = b.add<JsonArray>();
+    for (int d = 0; d < 6; d++) {
+      JsonArray row = days.add<JsonArray>();
+      row.add(d);
+      row.add(29 - d);
+      row.add(19 + d % 2);
+      row.add(d % WX_ICON_COUNT);
+    }
+    std::string one;
+    serializeMsgPack(doc, one);
+    bundle.wire = gzipBody(one + one); // Two locations
+    bundle.gzip = true;
+  }
+
+  CHECK(cycle(time, weather, 2, bundle, 0)); // Warm-up
+  struct mallinfo2 before = mallinfo2();
+  uint32_t callsBefore = heap_calls;
+  uint32_t bad = 0;
+  for (uint32_t n = 1; n <= CYCLES; n++)
+    bad += !cycle(time, weather, 2, bundle, n);
+  struct mallinfo2 after = mallinfo2();
+  uint32_t calls = heap_calls - callsBefore;
+
+  printf("%u cycles: %u heap calls, %ld bytes heap growth, arena peak %u of "
+         "%u bytes, %u overflows\n",
+         (unsigned)CYCLES, (unsigned)calls,
+         (long)(after.uordblks - before.uordblks), (unsigned)arena.peak(),
+         (unsigned)arena.capacity(), (unsigned)arena.overflows());
+  CHECK_EQ(bad, 0);
+  CHECK_EQ(calls, 0);
+  CHECK_EQ(after.uordblks, before.uordblks);
+  CHECK_EQ(arena.overflows(), 0);
+  return check_result("net_soak");
+}
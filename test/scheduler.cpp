@@ -0,0 +1,76 @@
+// Scheduler::runDue() against a fake microsecond clock: periodic jobs and
+// their lateness, and jobs that keep rescheduling to "now", which must run
+// once per call instead of pinning the UI loop.
+
+#include "Scheduler.h"
+#include "check.h"
+
+static uint32_t fakeUs;
+static uint32_t fakeClock() { return fakeUs; }
+
+static Scheduler sched;
+static int8_t selfId, pingId, pongId;
+static uint32_t selfRuns, pingRuns, pongRuns, tickRuns;
+
+// A redraw that always wants another one right away
+static void selfJob(void *) {
+  selfRuns++;
+  fakeUs += 10;
+  sched.reschedule(selfId, fakeUs);
+}
+
+// Two jobs that keep waking each other
+static void pingJob(void *) {
+  pingRuns++;
+  sched.reschedule(pongId, fakeUs);
+}
+static void pongJob(void *) {
+  pongRuns++;
+  sched.reschedule(pingId, fakeUs);
+}
+
+static void tickJob(void *) {
+  tickRuns++;
+  fakeUs += 300; // Takes a while
+}
+
+struct Null {
+  void println(const char *) {}
+};
+
+int main() {
+  fakeUs = 0xFFFFFF00u; // Deadlines wrap during the test
+  sched.every("tick", 1000, tickJob, NULL, fakeUs + 1000);
+  selfId = sched.once("self", selfJob, NULL, fakeUs);
+  pingId = sched.every("ping", 5000000, pingJob, NULL, fakeUs);
+  pongId = sched.every("pong", 5000000, pongJob, NULL, fakeUs + 5000000);
+
+  // Each call runs each due job once and reports the rest as due now
+  for (int i = 0; i < 10; i++) {
+    CHECK_EQ(sched.runDue(fakeClock), 0);
+    CHECK_EQ(selfRuns, i + 1);
+    CHECK_EQ(pingRuns + pongRuns, 2 * (i + 1));
+  }
+  CHECK_EQ(tickRuns, 0);
+
+  // Only the tick is left, 100 us of self runs into its first period
+  sched.cancel(selfId);
+  sched.cancel(pingId);
+  sched.cancel(pongId);
+  CHECK_EQ(sched.runDue(fakeClock), 1000 - 100);
+
+  // Late by 250 us, runs 300 us: the next deadline stays on the grid
+  fakeUs += 1000 - 100 + 250;
+  CHECK_EQ(sched.runDue(fakeClock), 1000 - 250 - 300);
+  CHECK_EQ(tickRuns, 1);
+  // Missed several periods: one catch-up run, then a full period
+  fakeUs += 5000;
+  CHECK_EQ(sched.runDue(fakeClock), 1000);
+  CHECK_EQ(tickRuns, 2);
+
+  sched.cancel(0);
+  CHECK_EQ(sched.runDue(fakeClock), Scheduler::NO_JOB);
+  Null null;
+  sched.report(null);
+  return check_result("scheduler");
+}
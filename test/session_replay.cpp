@@ -0,0 +1,123 @@
+// Replays recorded input sessions (the 'd' dump of the watch's SessionLog)
+// with a virtual clock standing in for millis(). The clock advances in
+// uneven steps, the way the UI loop wakes during a replay, and records are
+// pumped like pumpSessionReplay() does: everything due, but one touch
+// record per step. Each record must come out once its time has come and
+// within a step of it. Re-recording the replayed records must rebuild the
+// log byte for byte.
+//   session_replay sessions/calendar.session [more.session ...]
+
+#include "SessionLog.h"
+#include "check.h"
+#include <string>
+#include <vector>
+
+static const uint32_t MAX_STEP_MS = 7; // ui_wait() caps replay waits at 5
+
+struct Session {
+  std::vector<uint8_t> bytes;
+  unsigned records;
+  unsigned lastMs;
+};
+
+// "# expect: N records over M ms", then SESSION n, hex lines, END
+static bool loadSession(const char *path, Session &s) {
+  FILE *f = fopen(path, "r");
+  if (!f)
+    return false;
+  char line[256];
+  unsigned declared = 0;
+  bool body = false, done = false;
+  s.records = s.lastMs = 0;
+  while (fgets(line, sizeof(line), f)) {
+    if (line[0] == '#') {
+      sscanf(line, "# expect: %u records over %u ms", &s.records, &s.lastMs);
+    } else if (sscanf(line, "SESSION %u", &declared) == 1) {
+      body = true;
+    } else if (!strncmp(line, "END", 3)) {
+      done = true;
+      break;
+    } else if (body) {
+      for (const char *c = line; c[0] && c[1] && c[0] != '\n'; c += 2) {
+        unsigned byte;
+        if (sscanf(c, "%2x", &byte) != 1)
+          break;
+        s.bytes.push_back((uint8_t)byte);
+      }
+    }
+  }
+  fclose(f);
+  return done && s.bytes.size() == declared;
+}
+
+static void replay(const char *path) {
+  Session s;
+  if (!loadSession(path, s)) {
+    fprintf(stderr, "%s: can't read\n", path);
+    check_failures++;
+    return;
+  }
+
+  static uint8_t buf[64 * 1024], again[64 * 1024]; // SESSION_BUF_SIZE
+  SessionLog log, rec;
+  log.attach(buf, sizeof(buf));
+  rec.attach(again, sizeof(again));
+  CHECK(log.load(s.bytes.data(), s.bytes.size()));
+
+  uint32_t clock = 0xFFFFF000u; // Wraps during the replay
+  const uint32_t start = clock;
+  CHECK(log.startReplay(clock));
+  CHECK(rec.startRecording(start));
+  uint32_t rng = 12345, records = 0, touches = 0, lastMs = 0, worst = 0;
+  while (log.isReplaying()) {
+    rng = rng * 1103515245u + 12345u;
+    clock += 1 + (rng >> 16) % MAX_STEP_MS;
+    SessionRecord r;
+    while (log.nextDue(clock, r)) {
+      uint32_t late = clock - start - r.time;
+      CHECK(late < 0x80000000u); // Never early
+      if (late > worst)
+        worst = late;
+      CHECK(r.time >= lastMs);
+      lastMs = r.time;
+      records++;
+      rec.record(start + r.time, (SessionRecordType)r.type, r.a, r.b);
+      if (r.type == REC_TOUCH || r.type == REC_RELEASE) {
+        touches++;
+        break; // One per indev read
+      }
+    }
+  }
+  rec.stopRecording();
+
+  printf("%s: %u records (%u touch) over %u ms, at most %u ms late\n", path,
+         (unsigned)records, (unsigned)touches, (unsigned)lastMs,
+         (unsigned)worst);
+  CHECK_EQ(records, s.records);
+  CHECK_EQ(lastMs, s.lastMs);
+  CHECK(worst < MAX_STEP_MS);
+  CHECK(!rec.overflowed());
+  CHECK(rec.length() == log.length() &&
+        !memcmp(rec.data(), log.data(), log.length()));
+}
+
+// A version 1 log (with the dropped NET/BLE records) must not replay
+static void oldVersion() {
+  static const uint8_t v1[] = {'D', 'P', 'S', 1, 10, 5, 1};
+  uint8_t buf[16];
+  SessionLog log;
+  log.attach(buf, sizeof(buf));
+  CHECK(log.load(v1, sizeof(v1)));
+  CHECK(!log.startReplay(0));
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s session...\n", argv[0]);
+    return 2;
+  }
+  for (int i = 1; i < argc; i++)
+    replay(argv[i]);
+  oldVersion();
+  return check_result("session_replay");
+}
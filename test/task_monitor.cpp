@@ -0,0 +1,125 @@
+// TaskMonitor with made-up snapshots: run-time counters the way
+// uxTaskGetSystemState() reports them, then per-core idle tick counts the
+// way the tick hooks count them on a core built without run-time stats.
+// Checks shares, core loads, that each warning fires once per crossing,
+// and the report lines.
+
+#include "TaskMonitor.h"
+#include "check.h"
+#include <string>
+#include <vector>
+
+struct Lines {
+  std::vector<std::string> lines;
+  void println(const char *s) { lines.push_back(s); }
+};
+
+static void expect(const Lines &out, const char *const *want, size_t n) {
+  for (size_t i = 0; i < out.lines.size(); i++)
+    printf("%s\n", out.lines[i].c_str());
+  CHECK_EQ(out.lines.size(), n);
+  for (size_t i = 0; i < n && i < out.lines.size(); i++)
+    if (out.lines[i] != want[i]) {
+      fprintf(stderr, "line %zu: want \"%s\"\n", i, want[i]);
+      check_failures++;
+    }
+}
+
+// IDLE0, IDLE1, loopTask (core 1), net (core 0, low stack), log (unpinned)
+static void snapshot(TaskSample *s, uint32_t idle0, uint32_t idle1,
+                     uint32_t loop, uint32_t net, uint32_t log) {
+  const TaskSample rows[5] = {
+      {1, "IDLE0", 0, idle0, 1000},  {2, "IDLE1", 1, idle1, 1000},
+      {3, "loopTask", 1, loop, 4000}, {4, "net", 0, net, 500},
+      {5, "log", -1, log, 2000},
+  };
+  memcpy(s, rows, sizeof(rows));
+}
+
+static void runTimeStats() {
+  TaskMonitor m(768, 90);
+  TaskSample s[5];
+  uint32_t t0 = 0xFFF00000u; // The counter wraps in the second window
+  snapshot(s, 0, 0, 0, 0, 0);
+  CHECK_EQ(m.update(s, 5, t0), 1); // Low stack only; no window yet
+  CHECK(m.task(3).stackWarned);
+
+  snapshot(s, 600000, 50000, 900000, 300000, 100000);
+  CHECK_EQ(m.update(s, 5, t0 + 1000000), 4); // Core 1 busy
+  CHECK(!m.task(3).stackWarned);             // Still low, said already
+  CHECK(m.load(0) > 39.9f && m.load(0) < 40.1f);
+  CHECK(m.load(1) > 94.9f && m.load(1) < 95.1f);
+
+  Lines out;
+  m.report(out);
+  static const char *const want[] = {
+      "Tasks (CPU % of core over 1.0 s, stack free bytes):",
+      "  IDLE0           core 0  cpu  60.0%  stack   1000",
+      "  IDLE1           core 1  cpu   5.0%  stack   1000",
+      "  loopTask        core 1  cpu  90.0%  stack   4000",
+      "  net             core 0  cpu  30.0%  stack    500  LOW",
+      "  log             core -  cpu  10.0%  stack   2000",
+      "  load: core0 40.0%  core1 95.0%",
+  };
+  expect(out, want, sizeof(want) / sizeof(want[0]));
+
+  // Still busy: no new warning; idle again, then busy: warns again
+  snapshot(s, 1200000, 100000, 1800000, 600000, 200000);
+  CHECK_EQ(m.update(s, 5, t0 + 2000000), 0);
+  snapshot(s, 1800000, 1000000, 1900000, 900000, 300000);
+  CHECK_EQ(m.update(s, 5, t0 + 3000000), 0);
+  snapshot(s, 2400000, 1010000, 2800000, 1200000, 400000);
+  CHECK_EQ(m.update(s, 5, t0 + 4000000), 4);
+
+  // Idle ticks are ignored while run-time stats work
+  uint32_t idle[2] = {10, 10}, ticks[2] = {100, 100};
+  CHECK_EQ(m.updateIdle(idle, ticks), 0);
+  idle[0] = idle[1] = 110;
+  ticks[0] = ticks[1] = 200;
+  CHECK_EQ(m.updateIdle(idle, ticks), 0);
+  CHECK(m.load(1) > 98.9f);
+}
+
+static void idleTicks() {
+  TaskMonitor m(768, 90);
+  TaskSample s[5];
+  uint32_t idle[2] = {500, 900}, ticks[2] = {0xFFFFFF00u, 1000};
+  snapshot(s, 0, 0, 0, 0, 0);
+  CHECK_EQ(m.update(s, 5, 0), 1);
+  CHECK_EQ(m.updateIdle(idle, ticks), 0); // First sample: no window
+  CHECK_EQ(m.load(0), 0);
+
+  // 10 s at 1 kHz: core 0 idle the whole time, core 1 for 5%
+  idle[0] += 10000;
+  idle[1] += 500;
+  ticks[0] += 10000; // Wraps
+  ticks[1] += 10000;
+  CHECK_EQ(m.update(s, 5, 0), 0);
+  CHECK_EQ(m.updateIdle(idle, ticks), 4);
+
+  Lines out;
+  m.report(out);
+  static const char *const want[] = {
+      "Tasks (stack free bytes, run-time stats disabled):",
+      "  IDLE0           core 0  cpu   0.0%  stack   1000",
+      "  IDLE1           core 1  cpu   0.0%  stack   1000",
+      "  loopTask        core 1  cpu   0.0%  stack   4000",
+      "  net             core 0  cpu   0.0%  stack    500  LOW",
+      "  log             core -  cpu   0.0%  stack   2000",
+      "  load: core0 0.0%  core1 95.0%  (sampled idle ticks)",
+  };
+  expect(out, want, sizeof(want) / sizeof(want[0]));
+
+  // Core 0 gets busy; core 1 stays busy and doesn't warn again
+  idle[0] += 500;
+  idle[1] += 500;
+  ticks[0] += 10000;
+  ticks[1] += 10000;
+  CHECK_EQ(m.updateIdle(idle, ticks), 2);
+}
+
+int main() {
+  runTimeStats();
+  idleTicks();
+  return check_result("task_monitor");
+}
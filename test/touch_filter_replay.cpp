@@ -0,0 +1,150 @@
+// Drag lag and jitter of TouchFilter against the raw touch samples.
+// Synthetic finger paths are sampled the way lv_indev_read() sees them
+// (one read per ~30 ms LVGL input period, CHSC5816-like noise), so the true
+// finger position is known. For each path the raw and filtered streams are
+// scored on:
+//   jitter - RMS distance from the true point while the finger is still
+//   lag    - how far the output trails the finger along the motion, in ms
+// and the filter's own lagMs() estimate is printed beside them.
+
+#include "TouchFilter.h"
+#include "check.h"
+#include <math.h>
+#include <stdlib.h>
+
+// Deterministic noise so the numbers are the same on every run
+static uint32_t rng = 27;
+static float noise(float sigma) {
+  float sum = 0;
+  for (int i = 0; i < 4; i++) { // Roughly normal, stddev 1 before scaling
+    rng = rng * 1664525u + 1013904223u;
+    sum += (rng >> 8) / 16777216.0f - 0.5f;
+  }
+  return sum * 1.732f * sigma;
+}
+
+struct Path {
+  const char *name;
+  uint32_t ms;
+  float (*x)(float t), (*y)(float t); // True position at t seconds
+};
+
+static float still(float) { return 195; }
+static float slider(float t) { return 80 + 150 * (t < 1.5f ? t : 1.5f); }
+static float fling(float t) { return 60 + 600 * (t < 0.45f ? t : 0.45f); }
+static float circleX(float t) { return 195 + 100 * cosf(t * 4); }
+static float circleY(float t) { return 195 + 100 * sinf(t * 4); }
+
+struct Score {
+  double jitterSq;
+  uint32_t stillN;
+  double lagMs;
+  uint32_t movingN;
+
+  Score() : jitterSq(0), stillN(0), lagMs(0), movingN(0) {}
+
+  void add(const Path &p, float t, float ox, float oy) {
+    const float h = 0.001f;
+    float tx = p.x(t), ty = p.y(t);
+    float vx = (p.x(t + h) - p.x(t - h)) / (2 * h);
+    float vy = (p.y(t + h) - p.y(t - h)) / (2 * h);
+    float speed = hypotf(vx, vy);
+    if (speed < 1.0f) {
+      jitterSq += (ox - tx) * (ox - tx) + (oy - ty) * (oy - ty);
+      stillN++;
+    } else if (speed > 50.0f) {
+      // Distance behind the finger along its direction of travel
+      float behind = ((tx - ox) * vx + (ty - oy) * vy) / speed;
+      lagMs += behind / speed * 1000.0f;
+      movingN++;
+    }
+  }
+
+  float jitter() const { return stillN ? sqrt(jitterSq / stillN) : 0; }
+  float lag() const { return movingN ? lagMs / movingN : 0; }
+};
+
+struct Result {
+  Score raw, filtered;
+  float estimate; // TouchFilter::lagMs()
+};
+
+static Result replay(const Path &p, const TouchFilterConfig &cfg) {
+  TouchFilter f(cfg);
+  Result r;
+  rng = 27;
+  for (uint32_t ms = 0; ms <= p.ms; ms += 28 + ms % 5) {
+    float t = ms / 1000.0f;
+    int16_t x = (int16_t)lroundf(p.x(t) + noise(1.5f));
+    int16_t y = (int16_t)lroundf(p.y(t) + noise(1.5f));
+    r.raw.add(p, t, x, y);
+    f.apply(ms, x, y);
+    r.filtered.add(p, t, x, y);
+  }
+  r.estimate = f.lagMs();
+  return r;
+}
+
+// Two reads in the same ms must not throw the velocity estimate away
+static void sameMsReread() {
+  TouchFilterConfig cfg;
+  cfg.predictMs = 0;
+  TouchFilter f(cfg);
+  int16_t x = 0, y = 100;
+  for (uint32_t ms = 0; ms <= 300; ms += 30) {
+    x = 50 + ms / 2, y = 100;
+    f.apply(ms, x, y);
+  }
+  int16_t settledX = x;
+  x = 200, y = 100; // Same timestamp as the last read
+  f.apply(300, x, y);
+  CHECK_EQ(x, settledX); // Merged, not re-primed to the raw point
+  x = 50 + 330 / 2, y = 100;
+  f.apply(330, x, y);
+  CHECK(x > settledX && x < 50 + 330 / 2); // Still tracking, not restarted
+}
+
+int main() {
+  static const Path paths[] = {
+      {"hold", 1500, still, still},
+      {"slider 150px/s", 2000, slider, still},
+      {"fling 600px/s", 800, fling, still},
+      {"circle", 2000, circleX, circleY},
+  };
+  TouchFilterConfig on, off, noPredict;
+  off.enabled = false;
+  noPredict.predictMs = 0;
+
+  printf("%-16s %22s %22s %22s\n", "", "raw", "filtered",
+         "filtered, no predict");
+  printf("%-16s %10s %11s %10s %11s %10s %11s  %s\n", "", "jitter px",
+         "lag ms", "jitter px", "lag ms", "jitter px", "lag ms",
+         "lagMs() on/no predict");
+  for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+    const Path &p = paths[i];
+    Result raw = replay(p, off);
+    Result f = replay(p, on);
+    Result np = replay(p, noPredict);
+    printf("%-16s %10.2f %11.1f %10.2f %11.1f %10.2f %11.1f  %7.1f %7.1f\n",
+           p.name, raw.raw.jitter(), raw.raw.lag(), f.filtered.jitter(),
+           f.filtered.lag(), np.filtered.jitter(), np.filtered.lag(),
+           f.estimate, np.estimate);
+
+    if (p.x == still) {
+      // At rest the filter must take out a good part of the sensor noise
+      CHECK(f.filtered.jitter() < raw.raw.jitter() * 0.6f);
+    } else {
+      // Prediction must keep a drag within a frame of the raw input and
+      // beat the plain low-pass filter
+      CHECK(fabsf(f.filtered.lag()) < 16.0f);
+      CHECK(fabsf(f.filtered.lag()) < fabsf(np.filtered.lag()));
+      // lagMs() only sees the noisy raw samples, but measured along the
+      // motion it has to land near the real lag and show what prediction
+      // buys
+      CHECK(fabsf(f.estimate - f.filtered.lag()) < 8.0f);
+      CHECK(np.estimate > f.estimate + 5.0f);
+    }
+  }
+  sameMsReread();
+  return check_result("touch_filter_replay");
+}
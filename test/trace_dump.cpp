@@ -0,0 +1,78 @@
+// Tracer dumps printed a slice at a time, the way the log task prints them
+// after 'T', must match the one-shot dump line for line: header, name
+// table, the ring oldest record first (also after it wrapped), then END.
+// Tracing can't restart until the dump is out.
+
+#include "Trace.h"
+#include "check.h"
+#include <string>
+#include <vector>
+
+static uint32_t fakeUs = 0xFFFFFF00u;
+static uint32_t fakeClock() { return fakeUs += 7; }
+static uint8_t fakeCore() { return fakeUs & 1; }
+
+Tracer tracer(fakeClock, fakeCore);
+
+struct Lines {
+  std::vector<std::string> lines;
+  void println(const char *s) { lines.push_back(s); }
+};
+
+static void fill(uint32_t events) {
+  for (uint32_t i = 0; i < events; i++) {
+    if (i % 3 == 2)
+      TRACE_COUNTER(TR_FREE_HEAP, (int32_t)(100000 - i));
+    else if (i % 3 == 0)
+      TRACE_BEGIN(TR_LVGL);
+    else
+      TRACE_END(TR_LVGL);
+  }
+}
+
+static void check(uint32_t events, uint32_t capacity) {
+  static TraceRecord ring[64];
+  tracer.attach(ring, capacity);
+  CHECK(tracer.start());
+  fill(events);
+
+  Lines whole;
+  tracer.dump(whole);
+  uint32_t kept = events < capacity ? events : capacity;
+  char header[40];
+  snprintf(header, sizeof(header), "TRACE %u %u", (unsigned)kept,
+           (unsigned)(events - kept));
+  CHECK(!whole.lines.empty() && whole.lines[0] == header);
+  CHECK(!whole.lines.empty() && whole.lines.back() == "END");
+  CHECK_EQ(whole.lines.size(), 1 + TR_POINT_COUNT + (kept + 2) / 3 + 1);
+  // The oldest record kept comes first: event (events - kept)
+  if (kept && whole.lines.size() > 1 + TR_POINT_COUNT) {
+    const TraceRecord &r = ring[(events - kept) & (capacity - 1)];
+    char hex[8];
+    snprintf(hex, sizeof(hex), "%02x%02x", r.ts & 0xFF, (r.ts >> 8) & 0xFF);
+    CHECK(whole.lines[1 + TR_POINT_COUNT].compare(0, 4, hex) == 0);
+  }
+
+  static const uint32_t slices[] = {1, 7, 32};
+  for (size_t s = 0; s < sizeof(slices) / sizeof(slices[0]); s++) {
+    Lines sliced;
+    tracer.beginDump();
+    CHECK(!tracer.start()); // Would overwrite what is being printed
+    uint32_t passes = 0;
+    while (tracer.dumpSome(sliced, slices[s]))
+      passes++;
+    CHECK(!tracer.isDumping());
+    CHECK(sliced.lines == whole.lines);
+    CHECK(passes >= (whole.lines.size() - 1) / slices[s]);
+  }
+  CHECK(!tracer.dumpSome(whole, 10)); // Nothing more until beginDump()
+}
+
+int main() {
+  check(0, 64);
+  check(20, 64);
+  check(64, 64);
+  check(1000, 64); // Wrapped many times
+  check(100, 32);
+  return check_result("trace_dump");
+}
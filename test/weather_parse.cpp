@@ -0,0 +1,110 @@
+// Recorded OpenWeather bodies through the firmware's weather parse path:
+// the body arrives in TCP-sized pieces, goes through GzipReader (identity
+// and gzip, with and without Content-Length) into parseWeather() with the
+// network task's JsonArena, then drain() for keep-alive.
+//   weather_parse test/payloads
+
+#include "GzipReader.h"
+#include "JsonArena.h"
+#include "MockClient.h"
+#include "WeatherParser.h"
+#include "check.h"
+#include <math.h>
+
+struct Expect {
+  const char *file;
+  DeserializationError::Code err;
+  float temp;
+  const char *desc;
+};
+
+static const Expect expects[] = {
+    {"weather_bengaluru.json", DeserializationError::Ok, 24.31f, "Clouds"},
+    {"weather_mumbai_rain.json", DeserializationError::Ok, 27.99f, "Rain"},
+    {"weather_below_zero.json", DeserializationError::Ok, -3.0f, "Snow"},
+    {"weather_no_weather.json", DeserializationError::Ok, 18.25f, "--"},
+    // Cut to the 23 characters a FixedString<24> holds
+    {"weather_long_main.json", DeserializationError::Ok, 31.5f,
+     "Volcanic ash and thunde"},
+    {"error_401.json", DeserializationError::InvalidInput, 0, nullptr},
+    {"error_404.json", DeserializationError::InvalidInput, 0, nullptr},
+    {"error_429.json", DeserializationError::InvalidInput, 0, nullptr},
+    {"weather_no_temp.json", DeserializationError::InvalidInput, 0, nullptr},
+    {"weather_temp_string.json", DeserializationError::InvalidInput, 0,
+     nullptr},
+    {"weather_truncated.json", DeserializationError::IncompleteInput, 0,
+     nullptr},
+    {"weather_truncated_late.json", DeserializationError::IncompleteInput, 0,
+     nullptr},
+};
+
+static JsonArena<4096> arena; // NET_JSON_ARENA_BYTES
+static uint8_t window[GzipReader<MockClient>::WINDOW];
+static tinfl_decompressor inflater;
+
+static void run(const Expect &e, const std::string &json, bool gzip,
+                size_t segment, bool knownLength) {
+  std::string wire = gzip ? gzipBody(json) : json;
+  MockClient client(wire, segment);
+  GzipReader<MockClient> body(client, window, &inflater,
+                              knownLength ? (int32_t)wire.size() : -1);
+  char what[96];
+  snprintf(what, sizeof(what), "%s %s segment=%zu length=%s", e.file,
+           gzip ? "gzip" : "identity", segment, knownLength ? "yes" : "no");
+  if (!body.begin(gzip)) {
+    fprintf(stderr, "%s: gzip header rejected\n", what);
+    check_failures++;
+    return;
+  }
+
+  WeatherData w;
+  DeserializationError err = parseWeather(body, w, &arena);
+  bool drained = body.drain();
+  if (err.code() != e.err) {
+    fprintf(stderr, "%s: got %s, want %s\n", what, err.c_str(),
+            DeserializationError(e.err).c_str());
+    check_failures++;
+  }
+  CHECK(w.valid == (e.err == DeserializationError::Ok));
+  if (w.valid) {
+    CHECK(fabsf(w.temp - e.temp) < 0.005f);
+    if (strcmp(w.desc.c_str(), e.desc)) {
+      fprintf(stderr, "%s: desc \"%s\", want \"%s\"\n", what, w.desc.c_str(),
+              e.desc);
+      check_failures++;
+    }
+  }
+  // The next keep-alive request needs the whole body consumed
+  CHECK(drained == knownLength);
+  if (knownLength)
+    CHECK_EQ(body.wireBytes(), wire.size());
+  CHECK(!body.failed());
+  // The document is gone: the arena is empty for the next request
+  CHECK_EQ(arena.used(), 0);
+}
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s payload-dir\n", argv[0]);
+    return 2;
+  }
+  static const size_t segments[] = {1, 7, 536, 1460};
+  for (size_t i = 0; i < sizeof(expects) / sizeof(expects[0]); i++) {
+    const Expect &e = expects[i];
+    std::string json;
+    if (!readFile(std::string(argv[1]) + "/" + e.file, json)) {
+      fprintf(stderr, "%s: can't read\n", e.file);
+      check_failures++;
+      continue;
+    }
+    for (int gzip = 0; gzip < 2; gzip++)
+      for (size_t s = 0; s < sizeof(segments) / sizeof(segments[0]); s++)
+        for (int known = 0; known < 2; known++)
+          run(e, json, gzip, segments[s], known);
+    printf("%-28s %s\n", e.file, DeserializationError(e.err).c_str());
+  }
+  CHECK_EQ(arena.overflows(), 0);
+  printf("arena peak %u of %u bytes\n", (unsigned)arena.peak(),
+         (unsigned)arena.capacity());
+  return check_result("weather_parse");
+}
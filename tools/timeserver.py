@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Local stand-in for the watch's time sources: SNTP and a WorldTimeAPI-style
+HTTP endpoint, with adjustable delay and clock offset.
+
+Serve (point the firmware at it with -DTIME_HTTP_URL=... and
+-DTIME_NTP_SERVER_1=...; SNTP needs port 123, so run as root for that):
+    python3 tools/timeserver.py serve --ntp-port 123 --http-port 8080 \\
+        --ntp-delay 400 --http-delay 100 --offset 0.25
+
+Race both sources from the host, the same way the watch does:
+    python3 tools/timeserver.py race 127.0.0.1 --ntp-port 1123 --http-port 8080
+
+The race prints which reply arrived first, its time to first valid time and
+each source's offset from this machine's clock.
+"""
+
+import argparse
+import gzip
+import http.server
+import json
+import socket
+import socketserver
+import struct
+import sys
+import threading
+import time
+import urllib.request
+
+NTP_EPOCH = 2208988800  # 1900 -> 1970
+NTP_PACKET = struct.Struct("!BBbb11I")
+IST = 19800
+
+
+def to_ntp(t):
+    sec = int(t)
+    return sec + NTP_EPOCH, int((t - sec) * (1 << 32))
+
+
+def from_ntp(sec, frac):
+    return sec - NTP_EPOCH + frac / (1 << 32)
+
+
+def worldtime_json(t):
+    local = time.gmtime(t + IST)
+    frac = "%06d" % int((t - int(t)) * 1e6)
+    return {
+        "abbreviation": "IST",
+        "datetime": time.strftime("%Y-%m-%dT%H:%M:%S", local) + "." + frac +
+        "+05:30",
+        "timezone": "Asia/Kolkata",
+        "unixtime": int(t),
+        "utc_offset": "+05:30",
+    }
+
+
+def serve(args):
+    now = lambda: time.time() + args.offset
+
+    def ntp_loop():
+        sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        sock.bind(("", args.ntp_port))
+        while True:
+            data, addr = sock.recvfrom(512)
+            rx = now()
+            if len(data) < NTP_PACKET.size:
+                continue
+            time.sleep(args.ntp_delay / 1000.0)
+            fields = NTP_PACKET.unpack_from(data)
+            orig = fields[-2:]  # Client transmit timestamp
+            tx = now()
+            reply = NTP_PACKET.pack(0x24, 2, 6, -20, 0, 0, 0x4C4F434C,
+                                    *to_ntp(rx), *orig, *to_ntp(rx),
+                                    *to_ntp(tx))
+            sock.sendto(reply, addr)
+
+    class Handler(http.server.BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.0"
+
+        def do_GET(self):
+            time.sleep(args.http_delay / 1000.0)
+            body = json.dumps(worldtime_json(now())).encode()
+            zipped = "gzip" in self.headers.get("Accept-Encoding", "")
+            if zipped:
+                body = gzip.compress(body)
+            self.send_response(200)
+            self.send_header("Content-Type", "application/json")
+            if zipped:
+                self.send_header("Content-Encoding", "gzip")
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+        def log_message(self, fmt, *a):
+            sys.stderr.write("http %s\n" % (fmt % a))
+
+    threading.Thread(target=ntp_loop, daemon=True).start()
+    httpd = socketserver.ThreadingTCPServer(("", args.http_port), Handler)
+    print("ntp on udp/%d, http on tcp/%d, offset %+.3fs" %
+          (args.ntp_port, args.http_port, args.offset))
+    httpd.serve_forever()
+
+
+def query_ntp(host, port, timeout):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.settimeout(timeout)
+    t1 = time.time()
+    req = NTP_PACKET.pack(0x23, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                          *to_ntp(t1))
+    sock.sendto(req, (host, port))
+    data, _ = sock.recvfrom(512)
+    t4 = time.time()
+    f = NTP_PACKET.unpack_from(data)
+    t2, t3 = from_ntp(f[11], f[12]), from_ntp(f[13], f[14])
+    return ((t2 - t1) + (t3 - t4)) / 2  # Offset of the server clock
+
+
+def query_http(host, port, timeout):
+    url = "http://%s:%d/api/timezone/Asia/Kolkata" % (host, port)
+    sent = time.time()
+    with urllib.request.urlopen(url, timeout=timeout) as r:
+        doc = json.load(r)
+    rx = time.time()
+    frac = doc["datetime"].split(".")[1][:6] if "." in doc["datetime"] else ""
+    ref = doc["unixtime"] + (int(frac.ljust(6, "0")) / 1e6 if frac else 0)
+    return ref + (rx - sent) / 2 - rx
+
+
+def race(args):
+    results = []
+    lock = threading.Lock()
+    start = time.time()
+
+    def run(name, fn, port):
+        try:
+            offset = fn(args.host, port, args.timeout)
+        except Exception as e:  # Timeout, refused, bad reply
+            offset, name = None, "%s (%s)" % (name, e)
+        with lock:
+            results.append((time.time() - start, name, offset))
+
+    threads = [
+        threading.Thread(target=run, args=("ntp", query_ntp, args.ntp_port)),
+        threading.Thread(target=run,
+                         args=("http", query_http, args.http_port)),
+    ]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    valid = [r for r in results if r[2] is not None]
+    for at, name, offset in results:
+        print("%-6s after %6.1f ms  offset %s" %
+              (name, at * 1000,
+               "-" if offset is None else "%+.1f ms" % (offset * 1000)))
+    if not valid:
+        sys.exit("no valid reply")
+    print("winner: %s, time to first valid %.1f ms" %
+          (valid[0][1], valid[0][0] * 1000))
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    sub = p.add_subparsers(dest="cmd", required=True)
+    s = sub.add_parser("serve")
+    s.add_argument("--ntp-port", type=int, default=1123)
+    s.add_argument("--http-port", type=int, default=8080)
+    s.add_argument("--ntp-delay", type=float, default=0, help="ms")
+    s.add_argument("--http-delay", type=float, default=0, help="ms")
+    s.add_argument("--offset", type=float, default=0,
+                   help="seconds added to the served time")
+    r = sub.add_parser("race")
+    r.add_argument("host")
+    r.add_argument("--ntp-port", type=int, default=1123)
+    r.add_argument("--http-port", type=int, default=8080)
+    r.add_argument("--timeout", type=float, default=5)
+    args = p.parse_args()
+    serve(args) if args.cmd == "serve" else race(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""Convert a DeskPet trace dump (serial command 'T') to Chrome trace JSON.
+
+Usage:
+    python3 tools/trace2json.py serial.log > trace.json
+
+The input may contain other serial output; only the block between the
+"TRACE" header and "END" is read, minus the log lines ("[...") the watch
+prints in between while it streams the dump. Open the result in chrome://tracing or
+https://ui.perfetto.dev. Each core gets its own track.
+"""
+
+import json
+import struct
+import sys
+
+RECORD = struct.Struct("<IBBBxi")  # ts_us, point, phase, core, value
+
+
+def read_dump(lines):
+    names = {}
+    hexdata = []
+    inside = False
+    header = None
+    for raw in lines:
+        line = raw.strip()
+        if not inside:
+            if line.startswith("TRACE "):
+                inside = True
+                header = line.split()
+                names, hexdata = {}, []
+            continue
+        if line == "END":
+            inside = False
+            continue
+        if line.startswith("["):  # Log line from the log task
+            continue
+        if line.startswith("N "):
+            _, idx, name = line.split(" ", 2)
+            names[int(idx)] = name
+        else:
+            hexdata.append(line)
+    if header is None:
+        sys.exit("no TRACE block found")
+    return header, names, bytes.fromhex("".join(hexdata))
+
+
+def convert(names, data):
+    events = []
+    for core in (0, 1):
+        events.append({"ph": "M", "name": "thread_name", "pid": 1,
+                       "tid": core, "args": {"name": "core %d" % core}})
+
+    # Timestamps are a 32-bit micros() counter: unwrap in ring order
+    offset, prev, t0 = 0, None, None
+    depth = {}  # (core, point) -> open begins, drops ends without a begin
+    for pos in range(0, len(data) - RECORD.size + 1, RECORD.size):
+        ts, point, phase, core, value = RECORD.unpack_from(data, pos)
+        if prev is not None and ts + offset < prev - (1 << 31):
+            offset += 1 << 32
+        ts += offset
+        prev = ts
+        if t0 is None:
+            t0 = ts
+        name = names.get(point, "point%d" % point)
+        ev = {"name": name, "pid": 1, "tid": core, "ts": ts - t0}
+        phase = chr(phase)
+        key = (core, point)
+        if phase == "B":
+            depth[key] = depth.get(key, 0) + 1
+        elif phase == "E":
+            if not depth.get(key):
+                continue
+            depth[key] -= 1
+        elif phase == "C":
+            ev["args"] = {name: value}
+        else:
+            continue
+        ev["ph"] = phase
+        events.append(ev)
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    src = open(sys.argv[1]) if len(sys.argv) > 1 else sys.stdin
+    header, names, data = read_dump(src)
+    if len(header) > 2 and header[2] != "0":
+        print("note: %s older events were overwritten" % header[2],
+              file=sys.stderr)
+    json.dump(convert(names, data), sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
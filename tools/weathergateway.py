@@ -0,0 +1,306 @@
+#!/usr/bin/env python3
+"""Reference weather gateway: fetches OpenWeather current weather and the
+5-day forecast, aggregates them into daily rows and serves the watch one
+small MsgPack bundle per location (see WeatherBundle.h for the layout).
+
+GET /bundle?loc=12.97,77.59;19.08,72.88 answers with the bundles back to
+back, in the order asked (nil for a location the upstream failed on), so
+every configured location costs one request per sync.
+
+Serve (build the firmware with
+-DWEATHER_GATEWAY_URL=\\"http://host:8082/bundle\\"):
+    OPEN_WEATHER_API_KEY=... python3 tools/weathergateway.py serve
+or against the local stand-in, no key needed:
+    python3 tools/weatherserver.py serve --port 8081 &
+    python3 tools/weathergateway.py serve --upstream http://127.0.0.1:8081
+
+Compare what a sync costs through the gateway against direct JSON:
+    python3 tools/weathergateway.py compare --upstream http://127.0.0.1:8081
+
+compare prints the bytes of each body (identity and gzip) and the time to
+decode it here, and checks the bundle agrees with the JSON it came from.
+With several --loc it fetches each location's JSON over one keep-alive
+connection, as the watch does, against one batched bundle request.
+"""
+
+import argparse
+import gzip
+import http.client
+import http.server
+import json
+import os
+import socketserver
+import struct
+import sys
+import threading
+import time
+import urllib.parse
+import urllib.request
+
+BUNDLE_VERSION = 1
+DAYS = 6  # Forecast rows on the watch
+WX_SUN, WX_SUN_CLOUD, WX_CLOUD, WX_FOG = range(4)  # WeatherIcon
+
+
+def pack(v):
+    """Minimal MsgPack encoder: int, str, list and None are all we send."""
+    if v is None:
+        return b"\xc0"
+    if isinstance(v, bool):
+        return b"\xc3" if v else b"\xc2"
+    if isinstance(v, int):
+        if 0 <= v < 0x80:
+            return struct.pack("B", v)
+        if -32 <= v < 0:
+            return struct.pack("b", v)
+        for fmt, code in (("b", 0xd0), ("h", 0xd1), ("i", 0xd2)):
+            lim = 1 << (struct.calcsize(fmt) * 8 - 1)
+            if -lim <= v < lim:
+                return struct.pack(">B" + fmt, code, v)
+        if 0 <= v < 1 << 32:
+            return struct.pack(">BI", 0xce, v)
+        return struct.pack(">Bq", 0xd3, v)
+    if isinstance(v, str):
+        b = v.encode()
+        if len(b) < 32:
+            return struct.pack("B", 0xa0 | len(b)) + b
+        return struct.pack(">BB", 0xd9, len(b)) + b
+    if isinstance(v, (list, tuple)):
+        head = (struct.pack("B", 0x90 | len(v)) if len(v) < 16 else
+                struct.pack(">BH", 0xdc, len(v)))
+        return head + b"".join(pack(x) for x in v)
+    raise TypeError(type(v))
+
+
+def icon(row):
+    main = row["weather"][0]["main"]
+    if main == "Clear":
+        return WX_SUN
+    if main == "Clouds":
+        return WX_SUN_CLOUD if row["clouds"]["all"] < 50 else WX_CLOUD
+    return WX_FOG  # Rain, mist, haze, ...
+
+
+def days(forecast):
+    """Daily hi/lo and the icon nearest local noon, from 3-hour rows."""
+    tz = forecast["city"].get("timezone", 0)
+    by_day = {}
+    for row in forecast["list"]:
+        local = row["dt"] + tz
+        d = by_day.setdefault(local // 86400, [])
+        d.append((abs(local // 3600 % 24 - 12), row))
+    out = []
+    for day in sorted(by_day)[:DAYS]:
+        rows = [r for _, r in by_day[day]]
+        noon = min(by_day[day], key=lambda x: x[0])[1]
+        out.append([
+            (day + 4) % 7,  # 1970-01-01 was a Thursday
+            round(max(r["main"]["temp_max"] for r in rows)),
+            round(min(r["main"]["temp_min"] for r in rows)),
+            icon(noon),
+        ])
+    return out
+
+
+def bundle(current, forecast):
+    return pack([
+        BUNDLE_VERSION,
+        current["dt"],
+        int(round(current["main"]["temp"] * 10)),
+        current["weather"][0]["main"],
+        days(forecast),
+    ])
+
+
+def upstream_urls(args, lat, lon):
+    q = urllib.parse.urlencode({"lat": lat, "lon": lon, "units": "metric",
+                                "appid": args.appid})
+    return ("%s/data/2.5/weather?%s" % (args.upstream, q),
+            "%s/data/2.5/forecast?%s" % (args.upstream, q))
+
+
+def get(url, zipped=False, timeout=10):
+    req = urllib.request.Request(url)
+    if zipped:
+        req.add_header("Accept-Encoding", "gzip")
+    with urllib.request.urlopen(req, timeout=timeout) as r:
+        wire = r.read()
+        enc = r.headers.get("Content-Encoding", "identity")
+    return wire, gzip.decompress(wire) if enc == "gzip" else wire
+
+
+def serve(args):
+    cache = {}  # (lat, lon) -> (fetched, body)
+    lock = threading.Lock()
+
+    class Handler(http.server.BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.0"
+
+        def one(self, key):
+            with lock:
+                hit = cache.get(key)
+            if not hit or time.time() - hit[0] > args.ttl:
+                try:
+                    cur, fc = upstream_urls(args, *key)
+                    body = bundle(json.loads(get(cur)[1]),
+                                  json.loads(get(fc)[1]))
+                except Exception as e:  # Upstream down, bad key, ...
+                    sys.stderr.write("gateway %s: %s\n" % (key, e))
+                    return None
+                hit = (time.time(), body)
+                with lock:
+                    cache[key] = hit
+            return hit[1]
+
+        def do_GET(self):
+            q = urllib.parse.parse_qs(urllib.parse.urlparse(self.path).query)
+            if "loc" in q:
+                keys = [tuple(l.split(",", 1))
+                        for l in q["loc"][0].split(";") if "," in l]
+            else:
+                keys = [(q.get("lat", [args.lat])[0],
+                         q.get("lon", [args.lon])[0])]
+            bodies = [self.one(k) for k in keys]
+            if not any(bodies):
+                self.send_error(502, "no upstream data")
+                return
+            body = b"".join(b or pack(None) for b in bodies)
+            self.send_response(200)
+            self.send_header("Content-Type", "application/msgpack")
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+        def log_message(self, fmt, *a):
+            sys.stderr.write("gateway %s\n" % (fmt % a))
+
+    httpd = socketserver.ThreadingTCPServer(("", args.port), Handler)
+    print("bundle on tcp/%d, upstream %s, ttl %ds" %
+          (args.port, args.upstream, args.ttl))
+    httpd.serve_forever()
+
+
+def timed(fn, *a):
+    start = time.perf_counter()
+    for _ in range(100):
+        r = fn(*a)
+    return r, (time.perf_counter() - start) * 1e4  # us per call
+
+
+def unpack(b):
+    """Just enough MsgPack to check bundles: a list of the values in b."""
+    pos = [0]
+
+    def take(n):
+        v = b[pos[0]:pos[0] + n]
+        pos[0] += n
+        return v
+
+    def one():
+        c = take(1)[0]
+        if c < 0x80:
+            return c
+        if c == 0xc0:
+            return None
+        if c >= 0xe0:
+            return c - 0x100
+        if 0x90 <= c <= 0x9f:
+            return [one() for _ in range(c & 15)]
+        if 0xa0 <= c <= 0xbf:
+            return take(c & 31).decode()
+        fmt = {0xd0: "b", 0xd1: ">h", 0xd2: ">i", 0xd3: ">q", 0xce: ">I"}
+        if c in fmt:
+            return struct.unpack(fmt[c], take(struct.calcsize(fmt[c])))[0]
+        if c == 0xd9:
+            return take(take(1)[0]).decode()
+        if c == 0xdc:
+            return [one() for _ in range(struct.unpack(">H", take(2))[0])]
+        raise ValueError("msgpack 0x%02x" % c)
+
+    values = []
+    while pos[0] < len(b):
+        values.append(one())
+    return values
+
+
+def compare(args):
+    locs = args.loc or ["%s,%s" % (args.lat, args.lon)]
+    # Direct: current weather and forecast per location, on one connection
+    host = urllib.parse.urlparse(args.upstream)
+    conn = http.client.HTTPConnection(host.hostname, host.port or 80,
+                                      timeout=args.timeout)
+    connects = requests = 0
+    rows = {"json weather": [0, 0, 0.0], "json forecast": [0, 0, 0.0]}
+    docs = []
+    for loc in locs:
+        cur, fc = upstream_urls(args, *loc.split(","))
+        pair = []
+        for name, url in (("json weather", cur), ("json forecast", fc)):
+            for zipped in (False, True):
+                if conn.sock is None:
+                    connects += 1
+                requests += 1
+                path = url[len(args.upstream):]
+                conn.request("GET", path, headers={
+                    "Connection": "keep-alive",
+                    "Accept-Encoding": "gzip" if zipped else "identity"})
+                r = conn.getresponse()
+                wire = r.read()
+                if r.getheader("Content-Encoding") == "gzip":
+                    rows[name][1] += len(wire)
+                    continue
+                rows[name][0] += len(wire)
+                doc, us = timed(json.loads, wire)
+                rows[name][2] += us
+                pair.append(doc)
+        docs.append(pair)
+    conn.close()
+
+    # Gateway: every location in one request
+    gw = "%s?loc=%s" % (args.gateway, ";".join(locs))
+    wire, _ = get(gw, timeout=args.timeout)
+    bundles, us = timed(unpack, wire)
+    rows["bundle"] = [len(wire), len(gzip.compress(wire)), us]
+
+    print("%d location(s)" % len(locs))
+    print("%-14s %8s %8s %10s" % ("", "bytes", "gzipped", "decode us"))
+    for name, (n, z, us) in rows.items():
+        print("%-14s %8d %8d %10.1f" % (name, n, z, us))
+    direct = rows["json weather"][0] + rows["json forecast"][0]
+    print("direct JSON %d bytes in %d requests over %d connection(s), "
+          "bundle %d bytes in 1 (%.1fx)" %
+          (direct, requests // 2, connects, len(wire),
+           direct / float(len(wire))))
+    for loc, (cur, fc), b in zip(locs, docs, bundles):
+        if (b is None or b[0] != BUNDLE_VERSION or
+                b[2] != round(cur["main"]["temp"] * 10)):
+            sys.exit("bundle for %s disagrees with the JSON: %r" % (loc, b))
+        if b[4] != days(fc):
+            sys.exit("forecast rows for %s disagree with the JSON" % loc)
+    print("bundles match the JSON (%s forecast rows)" %
+          ", ".join(str(len(b[4])) for b in bundles))
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    p.add_argument("--upstream", default="http://api.openweathermap.org")
+    p.add_argument("--appid", default=os.environ.get("OPEN_WEATHER_API_KEY",
+                                                     ""))
+    p.add_argument("--lat", default="12.97")
+    p.add_argument("--lon", default="77.59")
+    sub = p.add_subparsers(dest="cmd", required=True)
+    s = sub.add_parser("serve")
+    s.add_argument("--port", type=int, default=8082)
+    s.add_argument("--ttl", type=int, default=600,
+                   help="seconds an upstream result is reused")
+    c = sub.add_parser("compare")
+    c.add_argument("--gateway", default="http://127.0.0.1:8082/bundle")
+    c.add_argument("--loc", action="append",
+                   help="lat,lon (repeat for several; default --lat/--lon)")
+    c.add_argument("--timeout", type=float, default=10)
+    args = p.parse_args()
+    serve(args) if args.cmd == "serve" else compare(args)
+
+
+if __name__ == "__main__":
+    main()
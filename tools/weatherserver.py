@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+"""Local stand-in for the OpenWeather current-weather and forecast endpoints,
+serving gzip bodies when the client asks for them.
+
+Serve (point the firmware at it with -DWEATHER_URL=..., or the gateway with
+--upstream; /data/2.5/forecast answers with 5 days of 3-hour rows):
+    python3 tools/weatherserver.py serve --port 8081
+
+Measure what gzip saves and check the inflated body matches the plain one:
+    python3 tools/weatherserver.py measure \
+        http://127.0.0.1:8081/data/2.5/weather
+
+measure fetches the URL with and without Accept-Encoding: gzip and prints
+the bytes of each body and the saving. It works against the real API too.
+"""
+
+import argparse
+import gzip
+import http.server
+import json
+import socketserver
+import sys
+import time
+import urllib.parse
+import urllib.request
+
+IST = 19800
+PLACES = {  # (lat, lon) as the watch sends them -> name, base temperature
+    ("12.97", "77.59"): ("Bengaluru", 24.31),
+    ("19.08", "72.88"): ("Mumbai", 29.12),
+    ("28.61", "77.21"): ("Delhi", 18.64),
+}
+
+
+def place(query):
+    q = urllib.parse.parse_qs(query)
+    key = (q.get("lat", ["12.97"])[0], q.get("lon", ["77.59"])[0])
+    return key, PLACES.get(key, ("Somewhere", 20.0))
+
+
+def weather_json(t, query=""):
+    # Same shape and field order as api.openweathermap.org/data/2.5/weather
+    (lat, lon), (name, temp) = place(query)
+    return {
+        "coord": {"lon": float(lon), "lat": float(lat)},
+        "weather": [{"id": 803, "main": "Clouds",
+                     "description": "broken clouds", "icon": "04d"}],
+        "base": "stations",
+        "main": {"temp": temp, "feels_like": round(temp + 0.2, 2),
+                 "temp_min": round(temp - 0.4, 2),
+                 "temp_max": round(temp + 0.8, 2), "pressure": 1013,
+                 "humidity": 69,
+                 "sea_level": 1013, "grnd_level": 913},
+        "visibility": 6000,
+        "wind": {"speed": 4.63, "deg": 260},
+        "clouds": {"all": 75},
+        "dt": int(t),
+        "sys": {"type": 1, "id": 9205, "country": "IN",
+                "sunrise": int(t) - 20000, "sunset": int(t) + 23000},
+        "timezone": IST,
+        "id": 1277333,
+        "name": name,
+        "cod": 200,
+    }
+
+
+def forecast_json(t, query=""):
+    # Same shape as /data/2.5/forecast: 40 rows, 3 hours apart
+    (lat, lon), (name, base) = place(query)
+    rows = []
+    start = int(t) // 10800 * 10800
+    for i in range(40):
+        dt = start + i * 10800
+        hour = (dt + IST) // 3600 % 24
+        temp = (base - 4.0 + 6.0 * (1 - abs(hour - 14) / 12.0) +
+                (i // 8) * 0.7)
+        main = ("Clear", "Clouds", "Clouds", "Rain", "Mist")[(i // 3) % 5]
+        rows.append({
+            "dt": dt,
+            "main": {"temp": round(temp, 2), "feels_like": round(temp, 2),
+                     "temp_min": round(temp - 0.8, 2),
+                     "temp_max": round(temp + 0.8, 2), "pressure": 1012,
+                     "sea_level": 1012, "grnd_level": 912, "humidity": 70,
+                     "temp_kf": 0},
+            "weather": [{"id": 803, "main": main,
+                         "description": main.lower(), "icon": "04d"}],
+            "clouds": {"all": 60},
+            "wind": {"speed": 3.9, "deg": 250, "gust": 6.1},
+            "visibility": 10000,
+            "pop": 0.2,
+            "sys": {"pod": "d" if 6 <= hour < 18 else "n"},
+            "dt_txt": time.strftime("%Y-%m-%d %H:%M:%S", time.gmtime(dt)),
+        })
+    return {
+        "cod": "200", "message": 0, "cnt": len(rows), "list": rows,
+        "city": {"id": 1277333, "name": name,
+                 "coord": {"lat": float(lat), "lon": float(lon)},
+                 "country": "IN",
+                 "population": 5104047, "timezone": IST,
+                 "sunrise": int(t) - 20000, "sunset": int(t) + 23000},
+    }
+
+
+def serve(args):
+    class Handler(http.server.BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.1"  # Keep-alive when asked for
+
+        def do_GET(self):
+            time.sleep(args.delay / 1000.0)
+            url = urllib.parse.urlparse(self.path)
+            doc = forecast_json if "/forecast" in url.path else weather_json
+            body = json.dumps(doc(time.time(), url.query),
+                              separators=(",", ":")).encode()
+            accept = self.headers.get("Accept-Encoding", "")
+            zipped = "gzip" in accept and not args.no_gzip
+            if zipped:
+                body = gzip.compress(body, args.level)
+            self.send_response(200)
+            self.send_header("Content-Type", "application/json")
+            if zipped:
+                self.send_header("Content-Encoding", "gzip")
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+        def log_message(self, fmt, *a):
+            sys.stderr.write("http %s\n" % (fmt % a))
+
+    httpd = socketserver.ThreadingTCPServer(("", args.port), Handler)
+    print("weather on tcp/%d, gzip %s" %
+          (args.port, "off" if args.no_gzip else "level %d" % args.level))
+    httpd.serve_forever()
+
+
+def fetch(url, zipped, timeout):
+    req = urllib.request.Request(url)
+    if zipped:
+        req.add_header("Accept-Encoding", "gzip")
+    start = time.time()
+    with urllib.request.urlopen(req, timeout=timeout) as r:
+        wire = r.read()
+        enc = r.headers.get("Content-Encoding", "identity")
+    ms = (time.time() - start) * 1000
+    body = gzip.decompress(wire) if enc == "gzip" else wire
+    return wire, body, enc, ms
+
+
+def measure(args):
+    plain, plain_body, _, plain_ms = fetch(args.url, False, args.timeout)
+    wire, body, enc, ms = fetch(args.url, True, args.timeout)
+    print("identity  %6d bytes  %6.1f ms" % (len(plain), plain_ms))
+    print("%-8s  %6d bytes  %6.1f ms" % (enc, len(wire), ms))
+    if enc != "gzip":
+        sys.exit("server ignored Accept-Encoding: gzip")
+    # Values like dt move between requests: compare the shape
+    a, b = json.loads(plain_body), json.loads(body)
+    strip = lambda d: {k: strip(v) if isinstance(v, dict) else type(v)
+                       for k, v in d.items()}
+    if strip(a) != strip(b):
+        sys.exit("inflated body differs from the plain one")
+    print("inflated %d bytes, saved %d bytes (%.0f%%)" %
+          (len(body), len(plain) - len(wire),
+           100.0 * (len(plain) - len(wire)) / len(plain)))
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    sub = p.add_subparsers(dest="cmd", required=True)
+    s = sub.add_parser("serve")
+    s.add_argument("--port", type=int, default=8081)
+    s.add_argument("--delay", type=float, default=0, help="ms")
+    s.add_argument("--level", type=int, default=6, help="gzip level")
+    s.add_argument("--no-gzip", action="store_true",
+                   help="always send identity bodies")
+    m = sub.add_parser("measure")
+    m.add_argument("url")
+    m.add_argument("--timeout", type=float, default=5)
+    args = p.parse_args()
+    serve(args) if args.cmd == "serve" else measure(args)
+
+
+if __name__ == "__main__":
+    main()